@@ -7,7 +7,11 @@
 #include <sys/uio.h>	// readv
 #include <vector>
 #include <string>
-#include <regex>
+#include <string_view>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include "Scan.hpp"
 
 namespace bre {
 
@@ -57,6 +61,25 @@ public:
         return buffer.data() + readPos;
     }
 
+    // 直接向可写区域写入（如 io_uring 的 recv），写完后调用 HasWritten
+    char* BeginWrite() {
+        return buffer.data() + writePos;
+    }
+
+    void HasWritten(size_t len) {
+        if (len > WritableBytes()) {
+            throw std::out_of_range("Buffer::HasWritten: len is too large");
+        }
+        writePos += len;
+    }
+
+    // 保证至少有 len 字节可写
+    void EnsureWriteable(size_t len) {
+        if (WritableBytes() < len) {
+            expandBuffer(len);
+        }
+    }
+
     std::string Retrieve(size_t len) {
         if (len > ReadableBytes()) {
             throw std::out_of_range("Buffer::Retrieve: len is too large");
@@ -66,23 +89,30 @@ public:
         return ret;
     }
 
+    // 跳过 len 字节（数据已被解析器以 string_view 直接使用，无需拷贝）
+    void Advance(size_t len) {
+        if (len > ReadableBytes()) {
+            throw std::out_of_range("Buffer::Advance: len is too large");
+        }
+        readPos += len;
+    }
+
     std::string RetrieveUntil(const std::string end) {
         if (ReadableBytes() < end.size()) {
             return "";
         }
 
-        const std::size_t pos = std::string(buffer.data() + readPos, buffer.data() + writePos).find(end);
-        if(pos == std::string::npos) {
+        const char* begin = Peek();
+        const char* last = buffer.data() + writePos;
+        const char* pos = find(begin, last, end);
+        if(pos == last) {
             // 如果是最后一行
-            std::size_t isLastLine = std::string(buffer.data() + readPos, buffer.data() + writePos).find("\n");
-            if (isLastLine == std::string::npos) {
+            if (Scan::FindByte2(begin, last, '\n', '\n') == last) {
                 return Retrieve(ReadableBytes());
-            } else {
-                std::cout << "RetrieveUntil: not found" << std::endl;
-                return "";
             }
+            return "";
         }
-        return Retrieve(pos + end.size());
+        return Retrieve(pos - begin + end.size());
     }
 
 
@@ -166,6 +196,23 @@ public:
 #endif // __linux__
 
 private:
+    // 先用 SIMD 跳到首字节的候选位置，再比较剩余部分
+    static const char* find(const char* begin, const char* last, std::string_view target) {
+        if (target.empty()) {
+            return begin;
+        }
+        for (const char* p = begin; static_cast<size_t>(last - p) >= target.size(); ++p) {
+            p = Scan::FindByte2(p, last - target.size() + 1, target[0], target[0]);
+            if (static_cast<size_t>(last - p) < target.size()) {
+                break;
+            }
+            if (std::memcmp(p, target.data(), target.size()) == 0) {
+                return p;
+            }
+        }
+        return last;
+    }
+
     void expandBuffer(size_t len) {
         if (WritableBytes() + readPos < len) {
             // 重置缓冲区
@@ -0,0 +1,293 @@
+#ifndef SCAN_HPP
+#define SCAN_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BRE_SCAN_X86 1
+#endif
+
+namespace bre {
+
+// HTTP 解析用的分隔符扫描：一次处理 16（SSE4.2）或 32（AVX2）字节，启动时按 CPU 选择实现，不支持时退回逐字节扫描
+// 所有函数返回 [p, end) 中第一个满足条件的位置，找不到时返回 end
+class Scan {
+public:
+    enum class Isa { Scalar, Sse42, Avx2 };
+
+    struct Ops {
+        // 第一个控制字符（0x00-0x1F 中除 HT 以外的字节以及 DEL），即行尾的 CR/LF 或非法字符
+        const char* (*findCtl)(const char* p, const char* end);
+        // 第一个不属于 token（RFC 9110 tchar）的字节，即方法、头部名的结束位置
+        const char* (*skipToken)(const char* p, const char* end);
+        // 第一个等于 a 或 b 的字节
+        const char* (*findByte2)(const char* p, const char* end, char a, char b);
+    };
+
+    static const char* FindCtl(const char* p, const char* end) {
+        return ops.findCtl(p, end);
+    }
+
+    static const char* SkipToken(const char* p, const char* end) {
+        return ops.skipToken(p, end);
+    }
+
+    static const char* FindByte2(const char* p, const char* end, char a, char b) {
+        return ops.findByte2(p, end, a, b);
+    }
+
+    static bool IsToken(char c) {
+        return tokenTable[static_cast<unsigned char>(c)];
+    }
+
+    static Isa Selected() {
+        return selected;
+    }
+
+    static const char* IsaName(Isa isa) {
+        switch (isa) {
+        case Isa::Avx2:
+            return "avx2";
+        case Isa::Sse42:
+            return "sse4.2";
+        default:
+            return "scalar";
+        }
+    }
+
+    // 当前 CPU 是否支持某个实现（测试和性能测试中逐个对比）
+    static bool Supported(Isa isa) {
+#ifdef BRE_SCAN_X86
+        __builtin_cpu_init();   // 可能在静态初始化阶段调用
+        if (isa == Isa::Avx2) {
+            return __builtin_cpu_supports("avx2");
+        }
+        if (isa == Isa::Sse42) {
+            return __builtin_cpu_supports("sse4.2");
+        }
+#endif
+        return isa == Isa::Scalar;
+    }
+
+    static Ops OpsFor(Isa isa) {
+        if (!Supported(isa)) {
+            isa = Isa::Scalar;
+        }
+#ifdef BRE_SCAN_X86
+        if (isa == Isa::Avx2) {
+            return {findCtlAvx2, skipTokenAvx2, findByte2Avx2};
+        }
+        if (isa == Isa::Sse42) {
+            return {findCtlSse42, skipTokenSse42, findByte2Sse42};
+        }
+#endif
+        return {findCtlScalar, skipTokenScalar, findByte2Scalar};
+    }
+
+private:
+    static constexpr std::array<bool, 256> makeTokenTable() {
+        std::array<bool, 256> t{};
+        for (int c = '0'; c <= '9'; ++c) t[c] = true;
+        for (int c = 'a'; c <= 'z'; ++c) t[c] = true;
+        for (int c = 'A'; c <= 'Z'; ++c) t[c] = true;
+        for (char c : {'!', '#', '$', '%', '&', '\'', '*', '+', '-', '.', '^', '_', '`', '|', '~'}) {
+            t[static_cast<unsigned char>(c)] = true;
+        }
+        return t;
+    }
+
+    // 半字节查表：高 4 位相同的字节按允许的低 4 位集合分组，每组一个比特
+    // token(c) 当且仅当 lo[c & 0xF] & hi[c >> 4] 非零（需要分组数不超过 8）
+    struct NibbleTables {
+        std::array<uint8_t, 16> lo{};
+        std::array<uint8_t, 16> hi{};
+    };
+
+    static constexpr NibbleTables makeNibbleTables() {
+        constexpr std::array<bool, 256> tokenTable = makeTokenTable();
+        NibbleTables t{};
+        std::array<uint16_t, 8> groups{};
+        int groupCount = 0;
+        for (int h = 0; h < 16; ++h) {
+            uint16_t set = 0;
+            for (int l = 0; l < 16; ++l) {
+                if (tokenTable[h * 16 + l]) {
+                    set |= static_cast<uint16_t>(1u << l);
+                }
+            }
+            if (set == 0) {
+                continue;
+            }
+            int g = 0;
+            while (g < groupCount && groups[g] != set) {
+                ++g;
+            }
+            if (g == groupCount) {
+                groups[groupCount++] = set;
+            }
+            t.hi[h] = static_cast<uint8_t>(1u << g);
+        }
+        for (int g = 0; g < groupCount; ++g) {
+            for (int l = 0; l < 16; ++l) {
+                if (groups[g] & (1u << l)) {
+                    t.lo[l] |= static_cast<uint8_t>(1u << g);
+                }
+            }
+        }
+        return t;
+    }
+
+    static bool isCtl(char c) {
+        unsigned char u = static_cast<unsigned char>(c);
+        return (u < 0x20 && u != '\t') || u == 0x7F;
+    }
+
+    static const char* findCtlScalar(const char* p, const char* end) {
+        while (p < end && !isCtl(*p)) {
+            ++p;
+        }
+        return p;
+    }
+
+    static const char* skipTokenScalar(const char* p, const char* end) {
+        while (p < end && IsToken(*p)) {
+            ++p;
+        }
+        return p;
+    }
+
+    static const char* findByte2Scalar(const char* p, const char* end, char a, char b) {
+        while (p < end && *p != a && *p != b) {
+            ++p;
+        }
+        return p;
+    }
+
+#ifdef BRE_SCAN_X86
+    // SSE4.2：控制字符用 pcmpestri 的范围比较，token 用 pshufb 半字节查表
+    __attribute__((target("sse4.2")))
+    static const char* findCtlSse42(const char* p, const char* end) {
+        static const char ranges[16] = "\x00\x08\x0A\x1F\x7F\x7F";
+        const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ranges));
+        for (; end - p >= 16; p += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            int idx = _mm_cmpestri(r, 6, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+            if (idx != 16) {
+                return p + idx;
+            }
+        }
+        return findCtlScalar(p, end);
+    }
+
+    __attribute__((target("sse4.2")))
+    static const char* skipTokenSse42(const char* p, const char* end) {
+        const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles.lo.data()));
+        const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles.hi.data()));
+        const __m128i mask = _mm_set1_epi8(0x0F);
+        for (; end - p >= 16; p += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(v, mask));
+            __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+            __m128i bad = _mm_cmpeq_epi8(_mm_and_si128(l, h), _mm_setzero_si128());
+            unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(bad));
+            if (bits) {
+                return p + __builtin_ctz(bits);
+            }
+        }
+        return skipTokenScalar(p, end);
+    }
+
+    __attribute__((target("sse4.2")))
+    static const char* findByte2Sse42(const char* p, const char* end, char a, char b) {
+        const __m128i set = _mm_setr_epi8(a, b, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+        for (; end - p >= 16; p += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            int idx = _mm_cmpestri(set, 2, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+            if (idx != 16) {
+                return p + idx;
+            }
+        }
+        return findByte2Scalar(p, end, a, b);
+    }
+
+    // AVX2：一次 32 字节，比较结果用 movemask 转成位图后取最低位
+    __attribute__((target("avx2")))
+    static const char* findCtlAvx2(const char* p, const char* end) {
+        const __m256i max = _mm256_set1_epi8(0x1F);
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i del = _mm256_set1_epi8(0x7F);
+        for (; end - p >= 32; p += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i low = _mm256_cmpeq_epi8(_mm256_min_epu8(v, max), v);    // v <= 0x1F
+            __m256i ctl = _mm256_or_si256(_mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab), low),
+                                          _mm256_cmpeq_epi8(v, del));
+            unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(ctl));
+            if (bits) {
+                return p + __builtin_ctz(bits);
+            }
+        }
+        return findCtlSse42(p, end);
+    }
+
+    __attribute__((target("avx2")))
+    static const char* skipTokenAvx2(const char* p, const char* end) {
+        const __m256i lo = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles.lo.data())));
+        const __m256i hi = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(nibbles.hi.data())));
+        const __m256i mask = _mm256_set1_epi8(0x0F);
+        for (; end - p >= 32; p += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(v, mask));
+            __m256i h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+            __m256i bad = _mm256_cmpeq_epi8(_mm256_and_si256(l, h), _mm256_setzero_si256());
+            unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(bad));
+            if (bits) {
+                return p + __builtin_ctz(bits);
+            }
+        }
+        return skipTokenSse42(p, end);
+    }
+
+    __attribute__((target("avx2")))
+    static const char* findByte2Avx2(const char* p, const char* end, char a, char b) {
+        const __m256i va = _mm256_set1_epi8(a);
+        const __m256i vb = _mm256_set1_epi8(b);
+        for (; end - p >= 32; p += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb));
+            unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+            if (bits) {
+                return p + __builtin_ctz(bits);
+            }
+        }
+        return findByte2Sse42(p, end, a, b);
+    }
+#endif // BRE_SCAN_X86
+
+    static Isa select() {
+        if (Supported(Isa::Avx2)) {
+            return Isa::Avx2;
+        }
+        if (Supported(Isa::Sse42)) {
+            return Isa::Sse42;
+        }
+        return Isa::Scalar;
+    }
+
+    static const std::array<bool, 256> tokenTable;
+    static const NibbleTables nibbles;
+    static const Isa selected;
+    static const Ops ops;
+};
+
+inline const std::array<bool, 256> Scan::tokenTable = Scan::makeTokenTable();
+inline const Scan::NibbleTables Scan::nibbles = Scan::makeNibbleTables();
+inline const Scan::Isa Scan::selected = Scan::select();
+inline const Scan::Ops Scan::ops = Scan::OpsFor(Scan::select());
+
+} // namespace bre
+#endif // SCAN_HPP
@@ -0,0 +1,93 @@
+// 对比各个指令集实现与逐字节实现的结果
+// g++ -std=c++20 -O2 testScan.cpp -o testScan
+#include <iostream>
+#include <cassert>
+#include <random>
+#include <string>
+#include <vector>
+#include "Scan.hpp"
+
+using namespace bre;
+
+static const Scan::Isa ISAS[] = {Scan::Isa::Scalar, Scan::Isa::Sse42, Scan::Isa::Avx2};
+
+// 大部分为 token 字符，按一定概率混入空格、冒号、CR/LF、HT、DEL 和高位字节
+std::string randomText(std::mt19937 &rng, size_t len) {
+    static const std::string rare = " :\r\n\t\x7f\x80\xff\"(),/;=?@[]{}";
+    std::string s(len, 'a');
+    for (auto &c : s) {
+        unsigned r = rng() % 100;
+        if (r < 3) {
+            c = rare[rng() % rare.size()];
+        } else if (r < 4) {
+            c = static_cast<char>(rng() % 256);
+        } else {
+            c = static_cast<char>('!' + rng() % 94);
+        }
+    }
+    return s;
+}
+
+void testAgainstScalar() {
+    std::mt19937 rng(12345);
+    Scan::Ops scalar = Scan::OpsFor(Scan::Isa::Scalar);
+    int checked = 0;
+    for (Scan::Isa isa : ISAS) {
+        if (!Scan::Supported(isa)) {
+            std::cout << Scan::IsaName(isa) << " not supported, skip" << std::endl;
+            continue;
+        }
+        Scan::Ops ops = Scan::OpsFor(isa);
+        // 覆盖 0~100 的每个长度（包括 16/32 的边界）以及不同的起始偏移
+        for (size_t len = 0; len <= 100; ++len) {
+            for (int round = 0; round < 200; ++round) {
+                std::string s = randomText(rng, len);
+                const char *begin = s.data();
+                const char *end = begin + s.size();
+                for (size_t off = 0; off <= len; off += 1 + len / 8) {
+                    const char *p = begin + off;
+                    assert(ops.findCtl(p, end) == scalar.findCtl(p, end));
+                    assert(ops.skipToken(p, end) == scalar.skipToken(p, end));
+                    assert(ops.findByte2(p, end, '\r', '\n') == scalar.findByte2(p, end, '\r', '\n'));
+                    assert(ops.findByte2(p, end, ':', ' ') == scalar.findByte2(p, end, ':', ' '));
+                    assert(ops.findByte2(p, end, '\x80', '\x80') == scalar.findByte2(p, end, '\x80', '\x80'));
+                    ++checked;
+                }
+            }
+        }
+        std::cout << Scan::IsaName(isa) << " ok" << std::endl;
+    }
+    std::cout << "checked " << checked << " cases, selected: " << Scan::IsaName(Scan::Selected()) << std::endl;
+}
+
+// 每个字节值单独放在 token 串中的各个位置
+void testEveryByte() {
+    Scan::Ops scalar = Scan::OpsFor(Scan::Isa::Scalar);
+    for (int c = 0; c < 256; ++c) {
+        bool ctl = (c < 0x20 && c != '\t') || c == 0x7f;
+        for (size_t pos = 0; pos < 40; ++pos) {
+            std::string s(40, 'x');
+            s[pos] = static_cast<char>(c);
+            const char *end = s.data() + s.size();
+            assert((scalar.findCtl(s.data(), end) == s.data() + pos) == ctl);
+            assert((scalar.skipToken(s.data(), end) == s.data() + pos) == !Scan::IsToken(static_cast<char>(c)));
+            for (Scan::Isa isa : ISAS) {
+                if (!Scan::Supported(isa)) {
+                    continue;
+                }
+                Scan::Ops ops = Scan::OpsFor(isa);
+                assert(ops.findCtl(s.data(), end) == scalar.findCtl(s.data(), end));
+                assert(ops.skipToken(s.data(), end) == scalar.skipToken(s.data(), end));
+            }
+        }
+    }
+    assert(Scan::IsToken('!') && Scan::IsToken('~') && Scan::IsToken('Z'));
+    assert(!Scan::IsToken(':') && !Scan::IsToken(' ') && !Scan::IsToken('\x80'));
+    std::cout << "every byte ok" << std::endl;
+}
+
+int main() {
+    testAgainstScalar();
+    testEveryByte();
+    return 0;
+}
@@ -0,0 +1,461 @@
+#ifndef FILE_CACHE_HPP
+#define FILE_CACHE_HPP
+
+#include "../mylog/Log.hpp"
+
+#include <fcntl.h>        // open
+#include <unistd.h>       // close, read
+#include <poll.h>         // poll
+#include <sys/stat.h>     // fstat
+#include <sys/eventfd.h>  // eventfd
+#include <sys/inotify.h>  // inotify_init1, inotify_add_watch
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace bre
+{
+    // 缓存的文件：元数据、内容类型，以及打开的 fd 或（小文件的）全部内容
+    // 响应持有 shared_ptr，条目被替换或淘汰后仍可安全发送，最后一个引用释放时关闭 fd
+    struct CachedFile
+    {
+        struct stat st{};
+        std::string type;
+        int fd = -1;          // 可发送且不在内存中的普通文件才打开
+        bool inMemory = false;
+        std::string data;     // inMemory 时为文件内容
+
+        // 以下由 HttpResponse 第一次使用时生成：校验器，以及 200 和 304 响应的状态行和头部（不含 Date）
+        // 数组下标 0 为短连接，1 为长连接
+        mutable std::once_flag headerOnce;
+        mutable std::string etag;
+        mutable std::string validators; // ETag 和 Last-Modified 两行
+        mutable std::string header[2];
+        mutable std::string notModified[2];
+
+        CachedFile() = default;
+        CachedFile(const CachedFile &) = delete;
+        CachedFile &operator=(const CachedFile &) = delete;
+
+        ~CachedFile()
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+
+        bool IsDir() const { return S_ISDIR(st.st_mode); }
+        bool Readable() const { return st.st_mode & S_IROTH; }
+        size_t Size() const { return static_cast<size_t>(st.st_size); }
+    };
+
+    // 所有连接和线程共享的静态文件缓存，命中时不产生任何文件系统调用
+    // 未命中时在调用线程内 open + fstat（小文件再 read），并监视所在目录
+    // 后台线程读取 inotify 事件，目录下文件被修改、替换、删除或改权限时移除对应条目
+    // 键为规范化后的路径，同一文件的不同写法（//、/./、/../）共用一个条目
+    // 条目数、内存中内容的总量和打开的 fd 数都有上限，满时淘汰任意旧条目
+    // inotify 不可用时不缓存，每次都直接打开
+    class FileCache
+    {
+    public:
+        static const size_t MAX_ENTRIES = 4096;
+        static const size_t SMALL_FILE = 16 * 1024;          // 不超过此大小的文件内容放在内存中
+        static const size_t MAX_MEMORY = 64 * 1024 * 1024;   // 内存中文件内容的总量上限
+        static const size_t MAX_FDS = 256;                   // 缓存持有的打开 fd 上限
+
+        FileCache(size_t maxEntries = MAX_ENTRIES, size_t smallFile = SMALL_FILE, size_t maxMemory = MAX_MEMORY,
+                  size_t maxFds = MAX_FDS)
+            : maxEntries(maxEntries), smallFile(smallFile), maxMemory(maxMemory), maxFds(maxFds)
+        {
+            notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (notifyFd < 0 || stopFd < 0)
+            {
+                Log::warn("inotify unavailable, file cache disabled");
+                return;
+            }
+            watcher = std::thread(&FileCache::watch, this);
+        }
+
+        ~FileCache()
+        {
+            if (watcher.joinable())
+            {
+                uint64_t one = 1;
+                [[maybe_unused]] ssize_t ret = write(stopFd, &one, sizeof(one));
+                watcher.join();
+            }
+            if (notifyFd >= 0)
+            {
+                close(notifyFd);
+            }
+            if (stopFd >= 0)
+            {
+                close(stopFd);
+            }
+        }
+
+        FileCache(const FileCache &) = delete;
+        FileCache &operator=(const FileCache &) = delete;
+
+        static FileCache &Instance()
+        {
+            static FileCache instance;
+            return instance;
+        }
+
+        // srcDir + path 对应的文件，不存在、打不开或 path 越出 srcDir 时返回 nullptr
+        // 目录和无读权限的文件也会返回（不打开），由调用者据此回复 404 / 403
+        std::shared_ptr<const CachedFile> Get(const std::string &srcDir, std::string_view path)
+        {
+            std::string key;
+            if (!makeKey(srcDir, path, key))
+            {
+                return nullptr;
+            }
+            {
+                std::shared_lock lock(mtx);
+                auto it = files.find(key);
+                if (it != files.end())
+                {
+                    return it->second;
+                }
+            }
+
+            // 先记下版本并监视目录，之后的改动都会使版本变化，打开期间被改动的文件不放入缓存
+            uint64_t gen = generation.load(std::memory_order_acquire);
+            bool watched = addWatch(key.substr(0, key.rfind('/')));
+            std::shared_ptr<CachedFile> file = load(key);
+            if (!file || !watched)
+            {
+                return file;
+            }
+            std::unique_lock lock(mtx);
+            size_t bytes = file->inMemory ? file->data.size() : 0;
+            size_t fds = file->fd >= 0 ? 1 : 0;
+            if (generation.load(std::memory_order_relaxed) != gen || bytes > maxMemory || fds > maxFds ||
+                maxEntries == 0)
+            {
+                return file;
+            }
+            auto it = files.find(key);
+            if (it != files.end())
+            {
+                return it->second; // 其他线程已经加载
+            }
+            // 淘汰任意条目直到放得下，仍被响应引用的旧条目在发送完后才关闭 fd
+            while (files.size() >= maxEntries || memory + bytes > maxMemory || openFds + fds > maxFds)
+            {
+                auto victim = files.begin();
+                if (openFds + fds > maxFds)
+                {
+                    while (victim->second->fd < 0)
+                    {
+                        ++victim;
+                    }
+                }
+                else if (memory + bytes > maxMemory)
+                {
+                    while (!victim->second->inMemory)
+                    {
+                        ++victim;
+                    }
+                }
+                erase(victim);
+            }
+            files.emplace(std::move(key), file);
+            memory += bytes;
+            openFds += fds;
+            return file;
+        }
+
+        // 是否已在缓存中（不加载），调用者据此决定 Get 能否在不阻塞的线程中进行
+        // 越出 srcDir 的路径视为命中：Get 直接返回 nullptr，不访问文件系统
+        bool Contains(const std::string &srcDir, std::string_view path) const
+        {
+            std::string key;
+            if (!makeKey(srcDir, path, key))
+            {
+                return true;
+            }
+            std::shared_lock lock(mtx);
+            return files.count(key) > 0;
+        }
+
+        size_t Size() const
+        {
+            std::shared_lock lock(mtx);
+            return files.size();
+        }
+
+        // 按后缀取 Content-type
+        static std::string TypeOf(std::string_view path)
+        {
+            size_t idx = path.find_last_of('.');
+            if (idx == std::string_view::npos)
+            {
+                return "text/plain";
+            }
+            auto it = suffixType.find(std::string(path.substr(idx)));
+            return it == suffixType.end() ? "text/plain" : it->second;
+        }
+
+    private:
+        // key = srcDir + 规范化后的 path：去掉空段和 "."，".." 回退一段，回退到 srcDir 之外时返回 false
+        static bool makeKey(const std::string &srcDir, std::string_view path, std::string &key)
+        {
+            key = srcDir;
+            size_t root = key.size();
+            size_t pos = 0;
+            while (pos < path.size())
+            {
+                size_t end = path.find('/', pos);
+                if (end == std::string_view::npos)
+                {
+                    end = path.size();
+                }
+                std::string_view seg = path.substr(pos, end - pos);
+                pos = end + 1;
+                if (seg.empty() || seg == ".")
+                {
+                    continue;
+                }
+                if (seg == "..")
+                {
+                    if (key.size() == root)
+                    {
+                        return false;
+                    }
+                    key.resize(key.rfind('/'));
+                    continue;
+                }
+                key += '/';
+                key += seg;
+            }
+            return true;
+        }
+
+        // 持有 mtx 时调用
+        void erase(std::unordered_map<std::string, std::shared_ptr<const CachedFile>>::iterator it)
+        {
+            if (it->second->inMemory)
+            {
+                memory -= it->second->data.size();
+            }
+            if (it->second->fd >= 0)
+            {
+                --openFds;
+            }
+            files.erase(it);
+        }
+
+        // 持有 mtx 时调用
+        void clear()
+        {
+            files.clear();
+            memory = 0;
+            openFds = 0;
+        }
+
+        std::shared_ptr<CachedFile> load(const std::string &fullPath)
+        {
+            int fd = open(fullPath.data(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                return nullptr;
+            }
+            auto file = std::make_shared<CachedFile>();
+            if (fstat(fd, &file->st) < 0)
+            {
+                close(fd);
+                return nullptr;
+            }
+            file->type = TypeOf(fullPath.substr(fullPath.rfind('/') + 1));
+            if (!S_ISREG(file->st.st_mode) || !file->Readable())
+            {
+                close(fd);
+                return file;
+            }
+            if (file->Size() <= smallFile)
+            {
+                file->data.resize(file->Size());
+                size_t got = 0;
+                while (got < file->data.size())
+                {
+                    ssize_t len = read(fd, file->data.data() + got, file->data.size() - got);
+                    if (len <= 0)
+                    {
+                        break;
+                    }
+                    got += len;
+                }
+                close(fd);
+                if (got != file->data.size())
+                {
+                    return nullptr; // 读取期间被截短
+                }
+                file->inMemory = true;
+                return file;
+            }
+            file->fd = fd;
+            return file;
+        }
+
+        bool addWatch(const std::string &dir)
+        {
+            if (notifyFd < 0)
+            {
+                return false;
+            }
+            {
+                std::shared_lock lock(mtx);
+                if (dirWatch.count(dir))
+                {
+                    return true;
+                }
+            }
+            int wd = inotify_add_watch(notifyFd, dir.data(),
+                                       IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                           IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+            if (wd < 0)
+            {
+                Log::warn("inotify_add_watch {} failed", dir);
+                return false;
+            }
+            // 同一目录经符号链接等不同写法监视时 wd 相同，记下所有写法
+            std::unique_lock lock(mtx);
+            if (dirWatch.emplace(dir, wd).second)
+            {
+                watchDir[wd].push_back(dir);
+            }
+            return true;
+        }
+
+        void watch()
+        {
+            alignas(inotify_event) char buf[4096];
+            pollfd fds[2] = {{notifyFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+            while (true)
+            {
+                if (poll(fds, 2, -1) < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    Log::err("file cache poll error");
+                    return;
+                }
+                if (fds[1].revents)
+                {
+                    return;
+                }
+                ssize_t len;
+                while ((len = read(notifyFd, buf, sizeof(buf))) > 0)
+                {
+                    std::unique_lock lock(mtx);
+                    generation.fetch_add(1, std::memory_order_release);
+                    for (char *p = buf; p < buf + len;)
+                    {
+                        const inotify_event *ev = reinterpret_cast<const inotify_event *>(p);
+                        onEvent(ev);
+                        p += sizeof(inotify_event) + ev->len;
+                    }
+                }
+            }
+        }
+
+        // 持有 mtx 时调用
+        void onEvent(const inotify_event *ev)
+        {
+            auto it = watchDir.find(ev->wd);
+            if ((ev->mask & (IN_Q_OVERFLOW | IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) || it == watchDir.end())
+            {
+                // 事件丢失或目录本身被移走：全部作废，目录下次未命中时重新监视
+                if (it != watchDir.end())
+                {
+                    if (!(ev->mask & IN_IGNORED))
+                    {
+                        inotify_rm_watch(notifyFd, ev->wd);
+                    }
+                    for (const std::string &dir : it->second)
+                    {
+                        dirWatch.erase(dir);
+                    }
+                    watchDir.erase(it);
+                }
+                clear();
+                return;
+            }
+            if (ev->len == 0)
+            {
+                return;
+            }
+            if (ev->mask & IN_ISDIR)
+            {
+                // 子目录被替换或删除，其下的条目都可能失效
+                clear();
+                return;
+            }
+            for (const std::string &dir : it->second)
+            {
+                auto file = files.find(dir + "/" + ev->name);
+                if (file != files.end())
+                {
+                    erase(file);
+                }
+            }
+        }
+
+        size_t maxEntries;
+        size_t smallFile;
+        size_t maxMemory;
+        size_t maxFds;
+
+        mutable std::shared_mutex mtx;
+        std::unordered_map<std::string, std::shared_ptr<const CachedFile>> files; // 键见 makeKey
+        size_t memory = 0;                                                      // 内存中文件内容的总字节数
+        size_t openFds = 0;                                                     // 条目持有的打开 fd 数
+        std::unordered_map<std::string, int> dirWatch;
+        std::unordered_map<int, std::vector<std::string>> watchDir;
+        std::atomic<uint64_t> generation{0}; // 每批 inotify 事件加一
+
+        int notifyFd = -1;
+        int stopFd = -1;
+        std::thread watcher;
+
+        static const std::unordered_map<std::string, std::string> suffixType;
+    };
+
+    inline const std::unordered_map<std::string, std::string> FileCache::suffixType{
+        {".html", "text/html"},
+        {".xml", "text/xml"},
+        {".xhtml", "application/xhtml+xml"},
+        {".txt", "text/plain"},
+        {".rtf", "application/rtf"},
+        {".pdf", "application/pdf"},
+        {".word", "application/nsword"},
+        {".png", "image/png"},
+        {".gif", "image/gif"},
+        {".jpg", "image/jpeg"},
+        {".jpeg", "image/jpeg"},
+        {".au", "audio/basic"},
+        {".mpeg", "video/mpeg"},
+        {".mpg", "video/mpeg"},
+        {".avi", "video/x-msvideo"},
+        {".gz", "application/x-gzip"},
+        {".tar", "application/x-tar"},
+        {".css", "text/css "},
+        {".js", "text/javascript "},
+    };
+
+} // namespace bre
+#endif // FILE_CACHE_HPP
@@ -4,12 +4,21 @@
 #include "../buffer/Buffer.hpp"
 #include "HttpRequest.hpp"
 #include "HttpResponse.hpp"
+#include "Router.hpp"
+#include "../pool/Strand.hpp"
 
 
 #include <sys/types.h>
 #include <sys/uio.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
 #include <arpa/inet.h>
 
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <climits>
+
 
 namespace bre
 {
@@ -20,6 +29,13 @@ public:
         fd = -1;
         addr = {};
         isClose = true;
+        iovPos = 0;
+        filePos = 0;
+        toWrite = 0;
+        respCnt = 0;
+        keepAlive = false;
+        msg = {};
+        request.SetHeadersHandler([](HttpRequest &req) { bodySink(req); });
     }
 
     ~HttpConn() {
@@ -36,9 +52,20 @@ public:
         isClose = false;
         readBuff.Clear();
         writeBuff.Clear();
+        request.Init();
+        deferred = false;
+        iov.clear();
+        files.clear();
+        iovPos = 0;
+        filePos = 0;
+        toWrite = 0;
+        respCnt = 0;
+        keepAlive = false;
         //Log::info("Client[{}]({}:{}) in, fd:{}", UserCount, GetIP(), GetPort(), fd);
     }
 
+    // 边沿触发时读到 EAGAIN 为止，但读缓冲区超过 READ_LIMIT 就先停下解析，流式接收的消息体不会整个堆在读缓冲区里
+    // 连接注册了 EPOLLONESHOT，重新注册 EPOLLIN 时若还有未读的数据会立即再次触发
     ssize_t Read(int* saveErrno) {
         ssize_t len = -1;
         do {
@@ -46,43 +73,68 @@ public:
             if (len <= 0) {
                 break;
             }
-        } while (IsET);
-        std::cout << readBuff.ToString() << std::endl;
+        } while (IsET && readBuff.ReadableBytes() < READ_LIMIT);
         return len;
     }
 
+    // 依次发送内存段（sendmsg）和文件段（sendfile），直到发完或出错（含 EAGAIN）
+    // 返回本次发送的字节数，一个字节都没发出时返回 -1
     ssize_t Write(int* saveErrno) {
-        ssize_t len = -1;
-        do {
-            len = writev(fd, iov, iovCnt);
-            if (len <= 0) {     // 出错
+        ssize_t sent = 0;
+        while (toWrite > 0) {
+            ssize_t len = FileNext() ? SendFile() : sendmsg(fd, Msg(), MsgFlags());
+            if (len < 0) {      // 出错
                 *saveErrno = errno;
-                break;
+                return sent > 0 ? sent : -1;
             }
-            if (iov[0].iov_len + iov[1].iov_len == 0) { // 数据已经发送完毕
-                break;
-            } else if (static_cast<size_t>(len) <= iov[0].iov_len) {    // 只发送了部分数据
-                iov[0].iov_base = static_cast<char*>(iov[0].iov_base) + len;
-                iov[0].iov_len -= len;
-                writeBuff.Retrieve(len);
-            } else {    // 发送了全部数据
-                size_t tlen = len - iov[0].iov_len;
-                iov[1].iov_base = static_cast<char*>(iov[1].iov_base) + tlen;
-                iov[1].iov_len -= tlen;
-                if (iov[0].iov_len) {
-                    writeBuff.RetrieveAll();
-                    iov[0].iov_len = 0;
+            Written(len);
+            sent += len;
+        }
+        return sent;
+    }
+
+    // 从当前文件段的偏移处发送，内容不经过用户态；文件被截短时返回 -1（EIO）
+    // 对端已关闭时返回 -1（EPIPE），前提是进程忽略了 SIGPIPE（见 WebServer）
+    ssize_t SendFile() {
+        const FileSeg &file = files[filePos];
+        off_t offset = file.end - static_cast<off_t>(iov[iovPos].iov_len);
+        ssize_t len = sendfile(fd, file.fd, &offset, iov[iovPos].iov_len);
+        if (len == 0) {
+            errno = EIO;
+            return -1;
+        }
+        return len;
+    }
+
+    // 已发送 len 字节，推进 iov；完成式引擎（io_uring）在写完成后直接调用
+    void Written(size_t len) {
+        toWrite -= len;
+        while (len > 0 && iovPos < iov.size()) {
+            iovec &cur = iov[iovPos];
+            if (len < cur.iov_len) {    // 只发送了这一段的一部分
+                if (cur.iov_base != nullptr) {
+                    cur.iov_base = static_cast<char*>(cur.iov_base) + len;
                 }
+                cur.iov_len -= len;
+                return;
             }
-        } while (IsET || ToWriteBytes() > 10240);
-        return len;
+            len -= cur.iov_len;
+            if (cur.iov_base == nullptr) {
+                ++filePos;
+            }
+            ++iovPos;
+        }
+        if (toWrite == 0) {
+            closeFiles();
+        }
     }
 
     void Close() {
-        response.UnmapFile();
-        if (isClose == false) {
+        closeFiles();
+        // 反应堆线程（超时、对端关闭）与工作线程可能同时关闭，只有一方真正 close
+        if (!isClose.exchange(true, std::memory_order_acq_rel)) {
             UserCount--;
-            isClose = true;
+            generation.fetch_add(1, std::memory_order_release);
             close(fd);
             //Log::info("Client[%d](%s:%d) quit, fd:%d", UserCount, GetIP(), GetPort(), fd);
         }
@@ -92,6 +144,64 @@ public:
         return fd;
     }
 
+    // 反应堆线程读取，工作线程经由 strand 写入
+    bool IsClose() const {
+        return isClose.load(std::memory_order_acquire);
+    }
+
+    // 每次关闭加一：fd 关闭后可能被其他反应堆的新连接复用，旧的定时任务据此识别并丢弃
+    uint64_t Generation() const {
+        return generation.load(std::memory_order_acquire);
+    }
+
+    // 最近一次活动的时间（反应堆的粗粒度时钟，毫秒），由所属反应堆写入
+    // 其他反应堆残留的定时任务可能在 fd 复用后读到，因此用原子变量
+    void Touch(int64_t nowMs) {
+        lastActive.store(nowMs, std::memory_order_relaxed);
+    }
+
+    int64_t LastActive() const {
+        return lastActive.load(std::memory_order_relaxed);
+    }
+
+    // 同一连接的读写任务都经由它串行执行
+    Strand& GetStrand() {
+        return strand;
+    }
+
+    Buffer& ReadBuffer() {
+        return readBuff;
+    }
+
+    // 下一段是否为文件：是则用 SendFile 发送，否则用 Msg 发送到下一个文件段之前的内存段
+    bool FileNext() const {
+        return iovPos < iov.size() && iov[iovPos].iov_base == nullptr;
+    }
+
+    // 尚未发送的内存段，到下一个文件段为止，一次最多 IOV_MAX 段
+    const struct iovec* Iov() const {
+        return iov.data() + iovPos;
+    }
+
+    int IovCnt() const {
+        size_t end = iovPos;
+        while (end < iov.size() && end - iovPos < IOV_MAX && iov[end].iov_base != nullptr) {
+            ++end;
+        }
+        return static_cast<int>(end - iovPos);
+    }
+
+    const struct msghdr* Msg() {
+        msg.msg_iov = const_cast<struct iovec*>(Iov());
+        msg.msg_iovlen = IovCnt();
+        return &msg;
+    }
+
+    // 后面还有数据（通常是紧跟头部的文件）时带上 MSG_MORE，头部与文件开头合并成满长度的报文
+    int MsgFlags() const {
+        return MSG_NOSIGNAL | (iovPos + IovCnt() < iov.size() ? MSG_MORE : 0);
+    }
+
     int GetPort() const {
         return addr.sin_port;
     }
@@ -104,65 +214,198 @@ public:
         return addr;
     }
     
-    bool Process() {
-        request.Init();
-        if (readBuff.ReadableBytes() <= 0) {
+    // 解析读缓冲区中所有完整的请求（流水线），按顺序生成响应，由一次 writev 一起发出
+    // 遇到短连接、错误或达到批量上限时停止，剩余请求在本批发送完后再处理
+    // 可能阻塞的请求（路由处理器查询 MySQL）在本批已有响应时留到下一批，先把前面的响应发出去
+    // canBlock 为 false（运行到完成模式，在反应堆线程内）时，它和未缓存的文件都留下来，由 MayBlock 告知调用者交给线程池
+    bool Process(bool canBlock = true) {
+        writeBuff.Advance(writeBuff.ReadableBytes());
+        respCnt = 0;
+        while (respCnt < MAX_PIPELINE && (deferred || readBuff.ReadableBytes() > 0)) {
+            // 留下的请求已经解析完并匹配过路由，直接继续处理
+            bool resumed = deferred;
+            deferred = false;
+            HttpRequest::ParseResult result = HttpRequest::ParseResult::Complete;
+            if (!resumed) {
+                result = request.Parse(readBuff);
+                if (result == HttpRequest::ParseResult::Incomplete) {
+                    // 请求还没收全，继续读
+                    break;
+                }
+            }
+            if (respCnt == responses.size()) {
+                responses.emplace_back();
+            }
+            HttpResponse &response = responses[respCnt];
+            headerEnd[respCnt] = 0;
+            string path(request.Path());
+            if (result == HttpRequest::ParseResult::Complete) {
+                if (!resumed) {
+                    Log::info("{}", path);
+                    if (!Router::Instance().Match(request.Path(), match)) {
+                        match.route = nullptr;
+                    }
+                }
+                if (match.route && match.route->handler->MayBlock(request) && (!canBlock || respCnt > 0)) {
+                    deferred = true;
+                    break;
+                }
+                keepAlive = request.IsKeepAlive();
+                response.Init(SrcDir, path, keepAlive, 200);
+                if (request.Method() == "GET" || request.Method() == "HEAD") {
+                    response.SetConditional(request.GetHeader(HeaderId::IfNoneMatch),
+                                            request.GetHeader(HeaderId::IfModifiedSince));
+                }
+                if (request.Method() == "GET") {
+                    response.SetRange(request.GetHeader(HeaderId::Range), request.GetHeader(HeaderId::IfRange));
+                }
+                if (match.route) {
+                    match.route->handler->Handle(request, match, response);
+                } else {
+                    response.Init(SrcDir, path, keepAlive, 404);
+                }
+                // 处理器只设置了路径，再来一次结果相同
+                if (!canBlock && !response.FileCached()) {
+                    deferred = true;
+                    break;
+                }
+            } else {
+                // 出错后连接会关闭，丢弃剩余数据
+                readBuff.Advance(readBuff.ReadableBytes());
+                keepAlive = false;
+                response.Init(SrcDir, path, false,
+                              result == HttpRequest::ParseResult::TooLarge ? 413 : 400);
+            }
+            response.MakeResponse(writeBuff);
+            headerEnd[respCnt++] = writeBuff.ReadableBytes();
+            if (!keepAlive) {
+                break;
+            }
+        }
+        if (respCnt == 0) {
             return false;
         }
-        bool praseCorrect = request.Parse(readBuff);
-        string path =  request.Path();
-        if (praseCorrect) {
-            Log::info("{}", path);
-            response.Init(SrcDir, path, request.IsKeepAlive(), 200);
-        } else {
-            response.Init(SrcDir, path, false, 400);
+        // 头部都写完后 writeBuff 不再移动，此时才取地址
+        iov.clear();
+        files.clear();
+        iovPos = 0;
+        filePos = 0;
+        toWrite = 0;
+        size_t buffPos = 0;
+        for (size_t i = 0; i < respCnt; ++i) {
+            HttpResponse &response = responses[i];
+            // 缓存文件预先生成的头部，之后是 writeBuff 中的其余头部，再依次是文件片段和它们之间的内容（multipart 的分隔行）
+            // 小文件在缓存的内存中，与头部一起 sendmsg；其余文件片段在 iov 中占一段，iov_base 为空，由 sendfile 发送
+            std::string_view block = response.HeaderBlock();
+            appendIov(const_cast<char*>(block.data()), block.size());
+            for (const HttpResponse::FileRange &range : response.Ranges()) {
+                appendIov(const_cast<char*>(writeBuff.Peek()) + buffPos, range.buffEnd - buffPos);
+                buffPos = range.buffEnd;
+                if (response.FileData()) {
+                    appendIov(const_cast<char*>(response.FileData()) + range.offset, range.len);
+                } else {
+                    iov.push_back({nullptr, range.len});
+                    files.push_back({response.FileFd(), static_cast<off_t>(range.offset + range.len)});
+                    toWrite += range.len;
+                }
+            }
+            appendIov(const_cast<char*>(writeBuff.Peek()) + buffPos, headerEnd[i] - buffPos);
+            buffPos = headerEnd[i];
         }
-        response.MakeResponse(writeBuff);
-        // 响应头部
-        iov[0].iov_base = const_cast<char*>(writeBuff.Peek());
-        iov[0].iov_len = writeBuff.ReadableBytes();
-        iovCnt = 1;
-
-        // 如果是文件请求 则iov[1]指向文件
-        // 文件请求
-        if (response.FileLen() > 0 && response.File()) {
-            iov[1].iov_base = response.File();
-            iov[1].iov_len = response.FileLen();
-            iovCnt = 2;
+        if (toWrite == 0) {
+            closeFiles();
         }
         return true;
     }
 
-    int ToWriteBytes() { 
-        return iov[0].iov_len + iov[1].iov_len; 
+    size_t ToWriteBytes() const {
+        return toWrite;
     }
 
+    // 本批最后一个响应是否保持连接
     bool IsKeepAlive() const {
-        return request.IsKeepAlive();
+        return keepAlive;
+    }
+
+    // 是否有 Process(false) 留下的请求：处理时可能阻塞（查询 MySQL 或读取未缓存的文件），应交给线程池
+    bool MayBlock() const {
+        return deferred;
     }
 
     static bool IsET;
     static const char* SrcDir;
-    static int UserCount;
+    static std::atomic<int> UserCount;    // 多个反应堆与工作线程共享
     
 private:
     int fd;
     struct  sockaddr_in addr;
 
-    bool isClose;
-    
-    int iovCnt;             // iov计数, 1表示只有iov[0], 2表示iov[0]和iov[1]
-    struct iovec iov[2];    // iov[0]指向writeBuff, iov[1]指向文件
+    std::atomic<bool> isClose;
     
+    void appendIov(char* base, size_t len) {
+        if (len > 0) {
+            // 相邻的头部（无文件的响应）合并成一段
+            if (!iov.empty() && iov.back().iov_base != nullptr &&
+                static_cast<char*>(iov.back().iov_base) + iov.back().iov_len == base) {
+                iov.back().iov_len += len;
+            } else {
+                iov.push_back({base, len});
+            }
+            toWrite += len;
+        }
+    }
+
+    // 按路由决定消息体交给谁：处理器不要的（包括没有匹配的路由）边到达边丢弃，不在连接中累积
+    static void bodySink(HttpRequest &req) {
+        RouteMatch peek;
+        if (Router::Instance().Peek(req.Path(), peek)) {
+            req.SetBodyHandler(peek.route->handler->BodySink(req, peek));
+        } else {
+            req.SetBodyHandler(HttpHandler::DiscardBody());
+        }
+    }
+
+    // 本批发送完后立即释放对缓存文件的引用，空闲的长连接不会让已失效的文件保持打开
+    void closeFiles() {
+        for (size_t i = 0; i < respCnt && i < responses.size(); ++i) {
+            responses[i].ReleaseFile();
+        }
+        files.clear();
+    }
+
+    static const size_t MAX_PIPELINE = 32;  // 一批最多处理的请求数
+    static const size_t READ_LIMIT = HttpRequest::MAX_REQUEST_SIZE; // 一次 Read 最多读到的缓冲数据量
+
+    struct FileSeg {
+        int fd;
+        off_t end;      // 发送到此偏移为止，当前偏移为 end 减去 iov 中剩余的长度
+    };
+
+    std::vector<struct iovec> iov;  // 依次为每个响应的头部（指向 writeBuff）和文件（iov_base 为空）
+    std::vector<FileSeg> files;     // iov 中文件段对应的文件，按顺序
+    size_t iovPos;                  // 第一段未发送完的 iov
+    size_t filePos;                 // 第一个未发送完的文件段
+    size_t toWrite;                 // 待发送的字节数
+    struct msghdr msg;              // Msg() 使用，io_uring 的 sendmsg 完成前须保持有效
+
     Buffer readBuff; // 读缓冲区
     Buffer writeBuff; // 写缓冲区
 
     HttpRequest request;
-    HttpResponse response;
+    std::deque<HttpResponse> responses;         // 按需增长并复用，deque 扩容时不移动已有元素（持有文件）
+    size_t headerEnd[MAX_PIPELINE] = {};        // 每个响应头部在 writeBuff 中的结束位置
+    size_t respCnt;                             // 本批响应数
+    bool keepAlive;
+    RouteMatch match;                           // 当前请求匹配到的路由
+    bool deferred = false;                      // request 已解析完，留到下一次 Process 处理
+
+    Strand strand;
+    std::atomic<int64_t> lastActive{0};
+    std::atomic<uint64_t> generation{0};
 };
 
 bool HttpConn::IsET = false;
-int HttpConn::UserCount  = 0;
+std::atomic<int> HttpConn::UserCount = 0;
 const char* HttpConn::SrcDir = nullptr;
 
 } // namespace bre
@@ -3,22 +3,48 @@
 #define HTTP_REQUEST_H
 
 #include "../buffer/Buffer.hpp"
+#include "../buffer/Scan.hpp"
+#include "KnownHeaders.hpp"
 #include "../mylog/Log.hpp"
 #include "../pool/Sqlconnpool.hpp"
 
 // #include <mysql/jdbc.h>
 #include <mysql_driver.h>
 
-#include <unordered_map>
-#include <unordered_set>
 #include <string>
 #include <string_view>
-#include <regex>
+#include <vector>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <memory_resource>
 // #include <prepared_statement>
 
 namespace bre
 {
 
+    // 支持以 string_view 查找，不构造临时字符串
+    struct StringHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const
+        {
+            return std::hash<std::string_view>{}(s);
+        }
+    };
+    // 按 string_view 比较，std::string 与 std::pmr::string 之间也能查找
+    struct StringEqual
+    {
+        using is_transparent = void;
+        bool operator()(std::string_view a, std::string_view b) const
+        {
+            return a == b;
+        }
+    };
+
     // GET /index.html HTTP/1.1
     // Host: example.com
     // User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/91.0.4472.124 Safari/537.36
@@ -54,6 +80,24 @@ namespace bre
             Finish
         };
 
+        enum class ParseResult
+        {
+            Complete,   // 解析出一个完整请求，已从缓冲区中取走
+            Incomplete, // 数据不完整，已解析的部分保留在状态中，收到更多数据后继续
+            Error,      // 格式错误，应返回 400 并关闭连接
+            TooLarge    // 消息体超过 MaxBody，应返回 413 并关闭连接
+        };
+
+        // 消息体的分帧方式与解码进度
+        enum class BodyState
+        {
+            Length,       // Content-Length：剩余 remaining 字节
+            ChunkSize,    // chunked：等待块大小行
+            ChunkData,    // chunked：块数据剩余 remaining 字节
+            ChunkDataEnd, // chunked：块数据后的 CRLF
+            Trailer       // chunked：尾部字段，空行结束
+        };
+
         enum class HttpStatusCode
         {
             NoRequest,
@@ -66,255 +110,732 @@ namespace bre
             ClosedConnection
         };
 
-        HttpRequest() { Init(); }
+        using Header = std::pair<std::string_view, std::string_view>;
+        using Field = std::pair<std::string_view, std::string_view>; // 解码后的表单字段或查询参数
+        // 流式接收消息体：每次最多 BODY_CHUNK 字节，数据在回调返回后失效
+        using BodyHandler = std::function<void(std::string_view)>;
+        // 有消息体的请求在头部解析完、消息体到达之前调用，可在其中按请求调用 SetBodyHandler
+        using HeadersHandler = std::function<void(HttpRequest &)>;
+
+        static const size_t MAX_REQUEST_SIZE = 64 * 1024; // 请求行 + 头部的上限，消息体由 MaxBody 限制
+        static constexpr size_t BODY_CHUNK = 16 * 1024;
+        static size_t MaxBody;                            // 消息体上限，配置项 MAXBODY
+        static const size_t ARENA_SIZE = 4096;           // 每个连接内置的 arena 块，超出时向堆申请
+
+        // 请求期间的所有数据（溢出头部、消息体、表单）都从 arena 分配
+        HttpRequest() : arena(arenaBlock, sizeof(arenaBlock)) { Init(); }
         ~HttpRequest() = default;
 
+        HttpRequest(const HttpRequest &) = delete;
+        HttpRequest &operator=(const HttpRequest &) = delete;
+
+        // 重置为新请求：先丢弃指向 arena 的容器，再整体释放 arena，不逐个 free
         void Init()
         {
-            method = path = version = body = "";
+            std::pmr::vector<Header>(&arena).swap(headers);
+            std::pmr::string(&arena).swap(headerBuf);
+            std::pmr::string(&arena).swap(bodyBuf);
+            std::pmr::vector<Field>(&arena).swap(post);
+            std::pmr::vector<Field>(&arena).swap(queryFields);
+            arena.release();
+
+            method = path = query = version = body = {};
             state = ParseState::RequestLine;
-            header.clear();
-            post.clear();
+            keepAlive = false;
+            known.fill({});
+            knownCount = 0;
+            contentLength = 0;
+            base = nullptr;
+            parsed = scanned = 0;
+            bodyState = BodyState::Length;
+            remaining = received = 0;
+            streaming = collect = false;
+            formParsed = queryParsed = false;
         }
 
-        bool Parse(Buffer &buff)
+        // 手写状态机解析，不使用正则、不拷贝：method/path/version/header 都是指向 buff 的 string_view
+        // 这些 view 在 buff 下一次写入前有效
+        // 可以断点续解析：Incomplete 时记住状态和已解析的字节数，下次从断点继续，每个字节只扫描一次
+        // 上一个请求完成后，下一次调用才会重置状态
+        // 消息体没有一次到齐或使用 chunked 时转为流式接收：请求行和头部拷贝到 headerBuf，
+        // 消息体边到达边交给 BodyHandler 并从 buff 中取走，连接占用的内存与消息体大小无关
+        ParseResult Parse(Buffer &buff)
         {
-            const char CRLF[] = "\r\n";
-            if (buff.ReadableBytes() < 1)
+            if (state == ParseState::Finish)
             {
-                return false;
+                Init();
             }
-
-            while (buff.ReadableBytes() && state != ParseState::Finish)
+            const char *begin = buff.Peek();
+            const char *end = begin + buff.ReadableBytes();
+            if (base != nullptr && base != begin)
             {
-                std::string line = buff.RetrieveUntil(CRLF);
-                line = line.substr(0, line.size() - 2);
+                // 缓冲区扩容或整理过，已解析部分的 view 跟着移动
+                rebase(base, begin);
+            }
+            base = begin;
+            const char *p = begin + parsed;
 
+            while (state != ParseState::Finish)
+            {
+                ParseResult ret = ParseResult::Complete;
                 switch (state)
                 {
                 case ParseState::RequestLine:
-                    if (!parseRequestLine(line))
-                    {
-                        return false;
-                    }
-                    parsePath();
+                    ret = parseRequestLine(p, end);
                     break;
                 case ParseState::Headers:
-                    parseHeader(line);
+                    ret = parseHeader(p, end);
                     break;
                 case ParseState::Body:
-                    parseBody(line);
+                    ret = parseBody(begin, p, end);
                     break;
                 default:
                     break;
                 }
-                if (buff.ReadableBytes() < 1)
+                if (ret == ParseResult::Incomplete && streaming)
                 {
-                    std::cout << "buff.ReadableBytes() < 1" << std::endl;
-                    break;
+                    // 已交付的消息体不再保留
+                    buff.Advance(p - begin);
+                    base = nullptr;
+                    p = begin = buff.Peek();
+                }
+                if (ret == ParseResult::Incomplete && buff.ReadableBytes() > MAX_REQUEST_SIZE)
+                {
+                    Log::err("Request too large");
+                    return ParseResult::Error;
+                }
+                if (ret != ParseResult::Complete)
+                {
+                    parsed = p - begin;
+                    return ret;
                 }
             }
+            buff.Advance(p - begin);
+            base = nullptr;
+            parsed = 0;
+            keepAlive = computeKeepAlive();
             Log::debug("method = {}, path = {}, version = {}",
                        method, path, version);
-            return true;
+            return ParseResult::Complete;
         }
 
-        std::string Path() const
+        std::string_view Path() const
         {
             return path;
         }
-        std::string &Path()
+        std::string_view Query() const
         {
-            return path;
+            return query;
         }
-        std::string Method() const
+        std::string_view Method() const
         {
             return method;
         }
-        std::string Version() const
+        std::string_view Version() const
         {
             return version;
         }
-        std::string GetPost(const std::string &key) const
+        std::string_view Body() const
+        {
+            return body;
+        }
+        // 常用头部：数组下标读取，不存在时返回空
+        std::string_view GetHeader(HeaderId id) const
         {
-            if (post.empty())
+            return known[static_cast<size_t>(id)];
+        }
+        // 头部名不区分大小写，不存在时返回空；常用头部经完美哈希定位，其余在溢出表中查找
+        std::string_view GetHeader(std::string_view name) const
+        {
+            HeaderId id = KnownHeaders::Lookup(name);
+            if (id != HeaderId::Unknown)
             {
-                return "";
+                return GetHeader(id);
             }
-            return post.find(key) == post.end() ? "" : post.at(key);
+            for (const auto &[key, value] : headers)
+            {
+                if (iequals(key, name))
+                {
+                    return value;
+                }
+            }
+            return {};
         }
-
-        bool IsKeepAlive() const
+        // 不在常用头部中的头部（以及常用头部的重复出现），按出现顺序
+        const std::pmr::vector<Header> &OtherHeaders() const
+        {
+            return headers;
+        }
+        size_t HeaderCount() const
+        {
+            return knownCount + headers.size();
+        }
+        // 依次访问所有头部：先是常用头部（按 HeaderId 顺序），再是其余头部
+        template <typename Func>
+        void ForEachHeader(Func &&func) const
         {
-            if (header.count("Connection") == 1)
+            for (size_t i = 0; i < KnownHeaders::COUNT; ++i)
+            {
+                if (known[i].data() != nullptr)
+                {
+                    func(KnownHeaders::NAMES[i], known[i]);
+                }
+            }
+            for (const auto &[key, value] : headers)
             {
-                return header.find("Connection")->second == "keep-alive" && version == "1.1";
+                func(key, value);
             }
-            return false;
+        }
+        // 表单字段（POST 且为 urlencoded），第一次调用时才解析消息体；同名字段取最后一个
+        // 不存在时返回的 view 的 data() 为空，返回的 view 在下一个请求开始前有效
+        std::string_view GetPost(std::string_view key)
+        {
+            if (!formParsed)
+            {
+                parsePost();
+            }
+            return findField(post, key);
+        }
+        // 查询参数，第一次调用时才解析；与表单不同，'+' 解码为空格，不去除前后空格
+        std::string_view GetQuery(std::string_view key)
+        {
+            if (!queryParsed)
+            {
+                queryParsed = true;
+                parseUrlencoded(query, queryFields, false);
+            }
+            return findField(queryFields, key);
         }
 
-        // private:
+        bool IsKeepAlive() const
+        {
+            return keepAlive;
+        }
+
+        // 设置后每个请求的消息体都按块交给 handler，除表单外不再收集到 Body()；连接存续期间有效，Init 不会清除
+        // 未设置时流式接收的消息体收集到 Body()，大小受 MaxBody 限制
+        void SetBodyHandler(BodyHandler handler)
+        {
+            bodyHandler = std::move(handler);
+        }
 
-        bool parseRequestLine(const std::string &line)
+        // HttpConn 用它按路由为每个请求选择 BodyHandler；连接存续期间有效
+        void SetHeadersHandler(HeadersHandler handler)
         {
-            // GET / HTTP/1.1
-            //  ([^ ]*)  匹配任意不是空格的字符
-            // ^ 表示匹配字符串的开始 $ 表示匹配字符串的结束
+            headersHandler = std::move(handler);
+        }
+
+        // private:
 
-            std::regex patten("^([^ ]*) ([^ ]*) HTTP/([^ ]*)$");
-            std::smatch subMatch;
-            if (std::regex_match(line, subMatch, patten))
+        // 取一行（不含行尾的 CRLF 或 LF）
+        // 用 Scan::FindCtl 一次跳过 16/32 字节：遇到的第一个控制字符只能是行尾，其余（含单独的 CR）都是非法请求
+        // 没有完整的一行时记下已扫描的长度，下次从那里继续
+        ParseResult getLine(const char *&p, const char *end, std::string_view &line)
+        {
+            const char *ctl = Scan::FindCtl(p + scanned, end);
+            if (ctl == end)
+            {
+                scanned = end - p;
+                return ParseResult::Incomplete;
+            }
+            if (*ctl == '\n')
+            {
+                line = std::string_view(p, ctl - p);
+                p = ctl + 1;
+                scanned = 0;
+                return ParseResult::Complete;
+            }
+            if (*ctl != '\r')
+            {
+                return ParseResult::Error;
+            }
+            if (ctl + 1 == end)
             {
-                method = subMatch[1];
-                path = subMatch[2];
-                version = subMatch[3];
-                state = ParseState::Headers;
-                return true;
+                scanned = ctl - p;
+                return ParseResult::Incomplete;
             }
-            Log::err("RequestLine Error");
-            return false;
+            if (ctl[1] != '\n')
+            {
+                return ParseResult::Error;
+            }
+            line = std::string_view(p, ctl - p);
+            p = ctl + 2;
+            scanned = 0;
+            return ParseResult::Complete;
         }
 
-        void parseHeader(const std::string &line)
+        // GET /index.html?key=value HTTP/1.1
+        ParseResult parseRequestLine(const char *&p, const char *end)
         {
+            std::string_view line;
+            ParseResult ret = getLine(p, end, line);
+            if (ret != ParseResult::Complete)
+            {
+                if (ret == ParseResult::Error)
+                {
+                    Log::err("RequestLine Error");
+                }
+                return ret;
+            }
+            const char *lineEnd = line.data() + line.size();
+            const char *methodEnd = Scan::SkipToken(line.data(), lineEnd);
+            if (methodEnd == line.data() || methodEnd == lineEnd || *methodEnd != ' ')
+            {
+                Log::err("RequestLine Error");
+                return ParseResult::Error;
+            }
+            const char *targetEnd = Scan::FindByte2(methodEnd + 1, lineEnd, ' ', ' ');
+            if (targetEnd == methodEnd + 1 || targetEnd == lineEnd)
+            {
+                Log::err("RequestLine Error");
+                return ParseResult::Error;
+            }
+            std::string_view target(methodEnd + 1, targetEnd - methodEnd - 1);
+            std::string_view proto(targetEnd + 1, lineEnd - targetEnd - 1);
+            if (proto.size() <= 5 || proto.substr(0, 5) != "HTTP/" ||
+                proto.find(' ') != std::string_view::npos)
+            {
+                Log::err("RequestLine Error");
+                return ParseResult::Error;
+            }
+            method = std::string_view(line.data(), methodEnd - line.data());
+            version = proto.substr(5);
+            size_t q = target.find('?');
+            path = target.substr(0, q);
+            query = q == std::string_view::npos ? std::string_view() : target.substr(q + 1);
+            state = ParseState::Headers;
+            return ParseResult::Complete;
+        }
 
-            // Host: www.baidu.com
-            // Accept: text/html等
-            std::regex patten("^([^:]*): ?(.*)$");
-            std::smatch subMatch;
-            if (std::regex_match(line, subMatch, patten))
+        // Host: www.baidu.com
+        // 空行表示头部结束
+        ParseResult parseHeader(const char *&p, const char *end)
+        {
+            std::string_view line;
+            ParseResult ret = getLine(p, end, line);
+            if (ret != ParseResult::Complete)
             {
-                header[subMatch[1]] = subMatch[2];
-                std::cout << "header[" << subMatch[1] << "] = " << subMatch[2] << std::endl;
+                if (ret == ParseResult::Error)
+                {
+                    Log::err("Header Error");
+                }
+                return ret;
+            }
+            if (line.empty())
+            {
+                return beginBody();
+            }
+            const char *lineEnd = line.data() + line.size();
+            const char *colon = Scan::SkipToken(line.data(), lineEnd);
+            if (colon == line.data() || colon == lineEnd || *colon != ':')
+            {
+                // 包括以空白开头的折行（obs-fold）
+                Log::err("Header Error");
+                return ParseResult::Error;
+            }
+            std::string_view value(colon + 1, lineEnd - colon - 1);
+            while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+            {
+                value.remove_prefix(1);
             }
-            else
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
             {
-                std::cout << "change " << line << std::endl;
-                state = ParseState::Body;
+                value.remove_suffix(1);
             }
+            return addHeader(std::string_view(line.data(), colon - line.data()), value);
         }
 
-        void parseBody(const std::string &line)
+        // 常用头部放进固定槽位，其余放进溢出表
+        // Host、Content-Length、Transfer-Encoding 重复出现时视为错误（防止请求走私），其他重复的放进溢出表
+        ParseResult addHeader(std::string_view name, std::string_view value)
         {
-            body = line;
-            parsePost();
-            state = ParseState::Finish;
-            Log::debug("Body = {}", body);
+            HeaderId id = KnownHeaders::Lookup(name);
+            if (id == HeaderId::Unknown)
+            {
+                headers.emplace_back(name, value);
+                return ParseResult::Complete;
+            }
+            std::string_view &slot = known[static_cast<size_t>(id)];
+            if (slot.data() != nullptr)
+            {
+                if (id == HeaderId::Host || id == HeaderId::ContentLength || id == HeaderId::TransferEncoding)
+                {
+                    Log::err("Duplicate header: {}", name);
+                    return ParseResult::Error;
+                }
+                headers.emplace_back(name, value);
+                return ParseResult::Complete;
+            }
+            slot = value; // 指向缓冲区，空值的 data() 也不为空，与“不存在”区分
+            ++knownCount;
+            return ParseResult::Complete;
         }
 
-        void parsePath()
+        // 头部结束：确定消息体的分帧方式
+        ParseResult beginBody()
         {
-            // 设置默认主页
-            if (path == "/")
+            std::string_view encoding = GetHeader(HeaderId::TransferEncoding);
+            std::string_view length = GetHeader(HeaderId::ContentLength);
+            if (!encoding.empty())
             {
-                path = "/index.html";
+                // 只支持 chunked，且不能同时出现 Content-Length（防止请求走私）
+                if (!length.empty() || !iequals(encoding, "chunked"))
+                {
+                    Log::err("Transfer-Encoding Error");
+                    return ParseResult::Error;
+                }
+                bodyState = BodyState::ChunkSize;
             }
-            else
+            else if (!length.empty())
             {
-                for (auto &item : defaultHtml)
+                auto [ptr, ec] = std::from_chars(length.data(), length.data() + length.size(), contentLength);
+                if (ec != std::errc() || ptr != length.data() + length.size())
                 {
-                    if (item == path)
-                    {
-                        path += ".html";
-                        break;
-                    }
+                    Log::err("Content-Length Error");
+                    return ParseResult::Error;
                 }
+                if (contentLength > MaxBody)
+                {
+                    Log::warn("Body too large: {}", contentLength);
+                    return ParseResult::TooLarge;
+                }
+                remaining = contentLength;
+            }
+            if (headersHandler && (bodyState != BodyState::Length || contentLength > 0))
+            {
+                headersHandler(*this);
             }
+            // 登录注册的表单需要完整的消息体；设置了 BodyHandler 时其余消息体只交给它，不保留
+            collect = !bodyHandler || GetHeader(HeaderId::ContentType) == "application/x-www-form-urlencoded";
+            state = ParseState::Body;
+            return ParseResult::Complete;
         }
 
-        void parsePost()
+        ParseResult parseBody(const char *begin, const char *&p, const char *end)
         {
-            if (method != "POST")
+            if (!streaming)
             {
-                return;
+                if (bodyState == BodyState::Length && static_cast<size_t>(end - p) >= contentLength)
+                {
+                    // 整个消息体已经到达：直接指向缓冲区，不拷贝
+                    body = std::string_view(p, contentLength);
+                    p += contentLength;
+                    deliver(body, false);
+                    state = ParseState::Finish;
+                    Log::debug("Body = {}", body);
+                    return ParseResult::Complete;
+                }
+                detach(begin, p);
             }
-            std::cout << "header[Content-Type]" << header["Content-Type"] << std::endl;
-            // 登录注册
-            if (method == "POST" && header["Content-Type"] == "application/x-www-form-urlencoded")
+            while (true)
             {
-                parseFromUrlencoded();
-                Log::debug("username = {}, password = {}", post["username"], post["password"]);
-                if (defaultHtmlTag.count(path))
+                switch (bodyState)
+                {
+                case BodyState::Length:
+                case BodyState::ChunkData:
                 {
-                    int tag = defaultHtmlTag.find(path)->second;
-                    if (tag == 0 || tag == 1)
+                    size_t len = std::min(remaining, static_cast<size_t>(end - p));
+                    deliver(std::string_view(p, len), collect);
+                    p += len;
+                    remaining -= len;
+                    if (remaining > 0)
                     {
-                        bool isLogin = tag;
-                        if (userVerify(post["username"], post["password"], isLogin))
-                        {
-                            path = "/welcome.html";
-                        }
-                        else
-                        {
-                            path = "/error.html";
-                        }
+                        return ParseResult::Incomplete;
                     }
+                    if (bodyState == BodyState::Length)
+                    {
+                        return finishBody();
+                    }
+                    bodyState = BodyState::ChunkDataEnd;
+                    break;
+                }
+                case BodyState::ChunkSize:
+                {
+                    // 1a;ext=value
+                    std::string_view line;
+                    ParseResult ret = getLine(p, end, line);
+                    if (ret != ParseResult::Complete)
+                    {
+                        return ret;
+                    }
+                    size_t size = 0;
+                    auto [ptr, ec] = std::from_chars(line.data(), line.data() + line.size(), size, 16);
+                    const char *lineEnd = line.data() + line.size();
+                    if (ec != std::errc() || ptr == line.data() ||
+                        (ptr != lineEnd && *ptr != ';' && *ptr != ' ' && *ptr != '\t'))
+                    {
+                        Log::err("Chunk size Error");
+                        return ParseResult::Error;
+                    }
+                    if (size > MaxBody - received)
+                    {
+                        Log::warn("Body too large");
+                        return ParseResult::TooLarge;
+                    }
+                    remaining = size;
+                    bodyState = size == 0 ? BodyState::Trailer : BodyState::ChunkData;
+                    break;
+                }
+                case BodyState::ChunkDataEnd:
+                {
+                    std::string_view line;
+                    ParseResult ret = getLine(p, end, line);
+                    if (ret != ParseResult::Complete)
+                    {
+                        return ret;
+                    }
+                    if (!line.empty())
+                    {
+                        Log::err("Chunk data Error");
+                        return ParseResult::Error;
+                    }
+                    bodyState = BodyState::ChunkSize;
+                    break;
+                }
+                case BodyState::Trailer:
+                {
+                    // 尾部字段直接忽略
+                    std::string_view line;
+                    ParseResult ret = getLine(p, end, line);
+                    if (ret != ParseResult::Complete)
+                    {
+                        return ret;
+                    }
+                    if (line.empty())
+                    {
+                        return finishBody();
+                    }
+                    break;
+                }
                 }
             }
-            // 其他请求
         }
 
-        // 解析Url
-        void parseFromUrlencoded()
+        // 转为流式接收：请求行和头部移到 headerBuf，此后 buff 中已解析的数据可以随时取走
+        // 长度已知时 bodyBuf 一次分配到位：arena 不回收旧块，逐步扩容会占用约两倍的消息体大小
+        void detach(const char *begin, const char *p)
         {
-            if (body.empty())
+            headerBuf.assign(begin, p);
+            rebase(begin, headerBuf.data());
+            streaming = true;
+            if (collect && bodyState == BodyState::Length)
+            {
+                bodyBuf.reserve(contentLength);
+            }
+        }
+
+        // 按 BODY_CHUNK 分块交给 BodyHandler，需要时收集到 bodyBuf
+        void deliver(std::string_view data, bool keep)
+        {
+            received += data.size();
+            if (keep)
+            {
+                bodyBuf.append(data);
+            }
+            if (!bodyHandler)
             {
                 return;
             }
+            while (!data.empty())
+            {
+                size_t len = std::min(data.size(), BODY_CHUNK);
+                bodyHandler(data.substr(0, len));
+                data.remove_prefix(len);
+            }
+        }
 
-            std::istringstream iss(body);
-            std::string key, value, token;
+        ParseResult finishBody()
+        {
+            body = bodyBuf;
+            state = ParseState::Finish;
+            Log::debug("Body received: {} bytes", received);
+            return ParseResult::Complete;
+        }
 
-            while (std::getline(iss, token, '&'))
-            { // 分割字符串为键值对
-                size_t equalPos = token.find('=');
-                if (equalPos != std::string::npos)
+        // 把指向旧缓冲区的 view 平移到新缓冲区的对应位置（只用地址值计算偏移，不访问旧内存）
+        void rebase(const char *from, const char *to)
+        {
+            auto move = [from, to](std::string_view &view)
+            {
+                if (!view.empty())
                 {
-                    key = decodePercentEncoding(token.substr(0, equalPos));    // 解码键
-                    value = decodePercentEncoding(token.substr(equalPos + 1)); // 解码值
-                    // 去除加号
-                    removePlus(key);
-                    removePlus(value);
-                    // 去除前后空格
-                    trim(key);
-                    trim(value);
-                    // 将解码后的键值对存入 map
-                    post[key] = value;
-                    Log::debug("{} = {}", key, value);
+                    uintptr_t offset = reinterpret_cast<uintptr_t>(view.data()) - reinterpret_cast<uintptr_t>(from);
+                    view = std::string_view(to + offset, view.size());
                 }
+            };
+            move(method);
+            move(path);
+            move(query);
+            move(version);
+            for (auto &value : known)
+            {
+                move(value);
+            }
+            for (auto &[key, value] : headers)
+            {
+                move(key);
+                move(value);
             }
         }
-        void trim(std::string &str)
+
+        bool computeKeepAlive() const
+        {
+            return iequals(GetHeader(HeaderId::Connection), "keep-alive") && version == "1.1";
+        }
+
+        static bool iequals(std::string_view a, std::string_view b)
         {
-            if (str.empty())
+            if (a.size() != b.size())
             {
-                return;
+                return false;
+            }
+            for (size_t i = 0; i < a.size(); ++i)
+            {
+                if (toLower(a[i]) != toLower(b[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static char toLower(char c)
+        {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+        }
+
+        // RFC 9110 token：字母数字和 !#$%&'*+-.^_`|~
+        static bool isToken(std::string_view s)
+        {
+            return !s.empty() && Scan::SkipToken(s.data(), s.data() + s.size()) == s.data() + s.size();
+        }
+
+        // 表单消息体解析到 post 中；登录注册由路由表中的 AuthHandler 处理
+        void parsePost()
+        {
+            formParsed = true;
+            if (method == "POST" && GetHeader(HeaderId::ContentType) == "application/x-www-form-urlencoded")
+            {
+                parseFromUrlencoded();
             }
-            str.erase(0, str.find_first_not_of(" "));
-            str.erase(str.find_last_not_of(" ") + 1);
         }
-        void removePlus(std::string &str)
+
+        void parseFromUrlencoded()
+        {
+            formParsed = true;
+            post.clear();
+            parseUrlencoded(body, post, true);
+        }
+
+        // 按 & 和 = 切分并解码，一遍完成；不含 %、+ 的键值直接指向 src，其余解码到 arena 中的一块内存
+        // 表单沿用原来的规则：去掉 '+'（包括 %2B 解码出的），去掉前后空格
+        void parseUrlencoded(std::string_view src, std::pmr::vector<Field> &fields, bool form)
         {
-            auto new_end = std::remove(str.begin(), str.end(), '+');
-            str.erase(new_end, str.end());
+            if (src.empty())
+            {
+                return;
+            }
+            char *out = static_cast<char *>(arena.allocate(src.size(), 1));
+            const char *p = src.data();
+            const char *end = p + src.size();
+            while (p < end)
+            {
+                const char *amp = Scan::FindByte2(p, end, '&', '&');
+                const char *eq = Scan::FindByte2(p, amp, '=', '=');
+                if (eq != amp)
+                {
+                    std::string_view key = decodeUrl(p, eq, out, form);
+                    std::string_view value = decodeUrl(eq + 1, amp, out, form);
+                    if (form)
+                    {
+                        key = trimSpace(key);
+                        value = trimSpace(value);
+                    }
+                    fields.emplace_back(key, value);
+                }
+                p = amp == end ? end : amp + 1;
+            }
         }
-        std::string decodePercentEncoding(const std::string &encodedStr)
+
+        // 解码 [p, end)：用 FindByte2 找到下一个 % 或 +，之前的部分整段移动；无效的 %XX 原样保留
+        // 需要解码时写到 out 并推进 out（解码后不会变长，out 可以等于 p，即原地解码）
+        static std::string_view decodeUrl(const char *p, const char *end, char *&out, bool form)
         {
-            std::string decodedStr;
-            for (size_t i = 0; i < encodedStr.length(); ++i)
+            const char *q = Scan::FindByte2(p, end, '%', '+');
+            if (q == end)
             {
-                if (encodedStr[i] == '%' && i + 2 < encodedStr.length())
+                return std::string_view(p, end - p);
+            }
+            char *begin = out;
+            while (true)
+            {
+                std::memmove(out, p, q - p);
+                out += q - p;
+                if (q == end)
                 {
-                    int num = static_cast<int>(strtol(encodedStr.substr(i + 1, 2).c_str(), nullptr, 16));
-                    decodedStr += static_cast<char>(num);
-                    i += 2;
+                    break;
+                }
+                int hi, lo;
+                if (*q == '+')
+                {
+                    if (!form)
+                    {
+                        *out++ = ' ';
+                    }
+                    p = q + 1;
+                }
+                else if (end - q > 2 && (hi = hexValue(q[1])) >= 0 && (lo = hexValue(q[2])) >= 0)
+                {
+                    char c = static_cast<char>(hi << 4 | lo);
+                    if (!form || c != '+')
+                    {
+                        *out++ = c;
+                    }
+                    p = q + 3;
                 }
                 else
                 {
-                    decodedStr += encodedStr[i];
+                    *out++ = '%';
+                    p = q + 1;
                 }
+                q = Scan::FindByte2(p, end, '%', '+');
             }
-            return decodedStr;
+            return std::string_view(begin, out - begin);
+        }
+
+        static int hexValue(char c)
+        {
+            if (c >= '0' && c <= '9')
+            {
+                return c - '0';
+            }
+            c = static_cast<char>(c | 0x20);
+            return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+        }
+
+        static std::string_view trimSpace(std::string_view s)
+        {
+            while (!s.empty() && s.front() == ' ')
+            {
+                s.remove_prefix(1);
+            }
+            while (!s.empty() && s.back() == ' ')
+            {
+                s.remove_suffix(1);
+            }
+            return s;
+        }
+
+        static std::string_view findField(const std::pmr::vector<Field> &fields, std::string_view key)
+        {
+            for (auto it = fields.rbegin(); it != fields.rend(); ++it)
+            {
+                if (it->first == key)
+                {
+                    return it->second;
+                }
+            }
+            return {};
         }
 
         // 用户验证
@@ -378,30 +899,37 @@ namespace bre
             return flag;
         }
 
+        // 请求内的数据（路径、头部、表单、拷贝的消息体）都从 arena 分配，Init 时整体释放，O(1) 且不逐个析构
+        // release 后重新从 arenaBlock 开始分配，常见请求不访问堆
+        alignas(std::max_align_t) std::byte arenaBlock[ARENA_SIZE];
+        std::pmr::monotonic_buffer_resource arena;
+
         ParseState state;
-        std::string method, path, version, body;
-        std::unordered_map<std::string, std::string> header;
-        std::unordered_map<std::string, std::string> post;
-
-        const std::unordered_set<std::string> defaultHtml{
-            "/index", "/register", "/login",
-            "/welcome", "/video", "/picture"};
-        const std::unordered_map<std::string, int> defaultHtmlTag{
-            {"/register.html", 0}, {"/login.html", 1}};
+        const char *base;     // 上次解析时缓冲区的起始位置
+        size_t parsed;        // 当前请求已解析的字节数
+        size_t scanned;       // 当前行已扫描的字节数
+        size_t contentLength;
+        BodyState bodyState;
+        size_t remaining;     // 当前消息体或块剩余的字节数
+        size_t received;      // 已收到的消息体字节数
+        bool streaming;       // 已转为流式接收，view 指向 headerBuf
+        bool collect;         // 是否把消息体收集到 bodyBuf
+        std::pmr::string headerBuf{&arena};
+        std::pmr::string bodyBuf{&arena};
+        BodyHandler bodyHandler;
+        HeadersHandler headersHandler;
+        std::string_view method, path, query, version, body; // 指向读缓冲区
+        bool keepAlive;
+        std::array<std::string_view, KnownHeaders::COUNT> known; // 常用头部，data() 为空表示不存在
+        size_t knownCount;
+        std::pmr::vector<Header> headers{&arena};               // 其余头部
+        std::pmr::vector<Field> post{&arena};        // 表单字段，GetPost 时才解析
+        std::pmr::vector<Field> queryFields{&arena}; // 查询参数，GetQuery 时才解析
+        bool formParsed;
+        bool queryParsed;
     };
 
+    size_t HttpRequest::MaxBody = 1024 * 1024;
+
 } // namespace bre
 #endif // HTTP_REQUEST_H
-
-// ([^:]*): ([^ ]*) 匹配任意不是冒号的字符，冒号，空格，任意不是空格的字符
-// std::regex patten("^([^:]*): ?(.*)$");
-// //if (line.find('Content-Type') != std::string::npos)
-// {
-//     std::cout << "parseHeader: " << line << std::endl;
-// }
-// std::smatch subMatch;
-// if (std::regex_match(line, subMatch, patten)) {
-//     header[subMatch[1]] = subMatch[2];
-// } else {
-//     state = ParseState::Body;
-// }
\ No newline at end of file
@@ -4,13 +4,17 @@
 
 #include "../buffer/Buffer.hpp"
 #include "../mylog/Log.hpp"
+#include "FileCache.hpp"
 
 #include <unordered_map>
-#include <fcntl.h>    // open
-#include <unistd.h>   // close
-#include <sys/stat.h> // stat
-#include <sys/mman.h> // mmap, munmap
+#include <array>
+#include <vector>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <filesystem>
 
@@ -23,17 +27,14 @@ namespace bre
     class HttpResponse
     {
     public:
+        static const size_t MAX_RANGES = 16; // Range 中更多的区间时忽略 Range，发送整个文件
+        static constexpr const char *BOUNDARY = "3d6b6a416f9b5bre"; // multipart/byteranges 的分隔符
+
         HttpResponse()
         {
             code = -1;
             path = srcDir = "";
             isKeepAlive = false;
-            mmFile = nullptr;
-            mmFileStat = {};
-        }
-        ~HttpResponse()
-        {
-            UnmapFile();
         }
 
         void Init(const std::string &srcDir, std::string &path, bool isKeepAlive = false, int code = -1)
@@ -42,25 +43,67 @@ namespace bre
             {
                 throw std::invalid_argument("srcDir is empty");
             }
-            if (mmFile)
-            {
-                UnmapFile();
-            }
+            ReleaseFile();
             this->isKeepAlive = isKeepAlive;
             this->path = path;
             this->srcDir = srcDir;
             this->code = code;
-            mmFile = nullptr;
-            mmFileStat = {};
+            block = {};
+            ifNoneMatch = ifModifiedSince = range = ifRange = {};
+            hasContent = false;
+            content.clear();
+        }
+
+        // 条件请求：GET / HEAD 的 If-None-Match 和 If-Modified-Since，指向请求的缓冲区，须在 MakeResponse 之前设置
+        void SetConditional(std::string_view ifNoneMatch, std::string_view ifModifiedSince)
+        {
+            this->ifNoneMatch = ifNoneMatch;
+            this->ifModifiedSince = ifModifiedSince;
+        }
+
+        // 范围请求：GET 的 Range 和 If-Range，同样指向请求的缓冲区
+        void SetRange(std::string_view range, std::string_view ifRange)
+        {
+            this->range = range;
+            this->ifRange = ifRange;
+        }
+
+        // 以下由路由处理器在 MakeResponse 之前调用
+        // 改为发送另一个文件（相对 srcDir）
+        void SetPath(std::string_view path)
+        {
+            this->path.assign(path);
+        }
+
+        // 直接生成的内容（如 /metrics），不读取文件
+        void SetContent(std::string body, std::string_view type)
+        {
+            content = std::move(body);
+            contentType.assign(type);
+            hasContent = true;
+        }
+
+        // MakeResponse 是否不必访问文件系统：直接生成的内容、错误页面，或文件已在缓存中
+        bool FileCached() const
+        {
+            return hasContent || code >= 400 || FileCache::Instance().Contains(srcDir, path);
         }
 
         void MakeResponse(Buffer &buff)
         {
-            if (stat((srcDir + path).data(), &mmFileStat) < 0 || S_ISDIR(mmFileStat.st_mode))
+            if (code >= 400)
+            {
+                // 解析阶段已经确定的错误（如 400），不再按路径查找文件
+            }
+            else if (hasContent)
+            {
+                code = 200;
+            }
+            else if (!(file = FileCache::Instance().Get(srcDir, path)) || file->IsDir())
             {
                 code = 404;
             }
-            else if (!(mmFileStat.st_mode & S_IROTH))
+            else if (!file->Readable())
             {
                 code = 403;
             }
@@ -68,29 +111,87 @@ namespace bre
             {
                 code = 200;
             }
+            if (code == 200 && file)
+            {
+                // 缓存文件：预先生成的头部由 HttpConn 直接发送，这里只写 Date 和空行
+                // 客户端的副本仍有效时回复 304，不发送消息体
+                // 有效的 Range 请求回复 206（或 416），头部随区间变化，在 buff 中生成
+                prepare(*file);
+                if (notModified(*file))
+                {
+                    code = 304;
+                    block = file->notModified[isKeepAlive];
+                }
+                else if (!range.empty() && ifRangeMatch(*file) && makeRanges(buff))
+                {
+                    return;
+                }
+                else
+                {
+                    block = file->header[isKeepAlive];
+                }
+                addDate(buff);
+                buff.Append("\r\n", 2);
+                if (code == 200)
+                {
+                    addRange(buff.ReadableBytes(), 0, file->Size());
+                }
+                return;
+            }
             errorHtml();
             addStateLine(buff);
             addHeader(buff);
             addContent(buff);
         }
 
-        void UnmapFile()
+        // 响应发送完毕（或连接关闭）后释放对缓存文件的引用
+        void ReleaseFile()
         {
-            if (mmFile)
-            {
-                munmap(mmFile, mmFileStat.st_size);
-                mmFile = nullptr;
-            }
+            block = {};
+            ranges.clear();
+            file.reset();
+        }
+
+        // 预先生成的状态行和头部（除 Date 外），在 MakeResponse 写入 buff 的内容之前发送；没有时为空
+        std::string_view HeaderBlock() const
+        {
+            return block;
+        }
+
+        // 消息体中的文件片段：先发送 buff 中到 buffEnd 为止的内容（相对 MakeResponse 之前 buff 的可读起点，
+        // 同一批的多个响应连续写入时即为在 buff 中的位置），再发送文件的 [offset, offset + len)
+        struct FileRange
+        {
+            size_t buffEnd;
+            size_t offset;
+            size_t len;
+        };
+
+        const std::vector<FileRange> &Ranges() const
+        {
+            return ranges;
         }
 
-        char *File()
+        // 片段的来源：小文件在内存中（FileData 非空），其余由 HttpConn 从 FileFd sendfile
+        int FileFd() const
         {
-            return mmFile;
+            return file ? file->fd : -1;
         }
 
+        const char *FileData() const
+        {
+            return file && file->inMemory ? file->data.data() : nullptr;
+        }
+
+        // 消息体中来自文件的字节数
         size_t FileLen() const
         {
-            return mmFileStat.st_size;
+            size_t len = 0;
+            for (const FileRange &r : ranges)
+            {
+                len += r.len;
+            }
+            return len;
         }
 
         void ErrorContent(Buffer &buff, std::string message)
@@ -99,7 +200,7 @@ namespace bre
             string status;
             body += "<html><title>Error</title>";
             body += "<body bgcolor=\"fff000\">";
-            if (codePath.count(code) == 1)
+            if (codeStatus.count(code) == 1)
             {
                 status = codeStatus.find(code)->second;
                 body += std::to_string(code) + " : " + status;
@@ -134,9 +235,16 @@ namespace bre
         }
 
         void addHeader(Buffer &buff)
+        {
+            addConnection(buff, isKeepAlive);
+            buff.Append("Content-type: " + (hasContent ? contentType : file ? file->type : getFileType()) + "\r\n");
+            addDate(buff);
+        }
+
+        static void addConnection(Buffer &buff, bool keepAlive)
         {
             buff.Append("Connection: ");
-            if (isKeepAlive)
+            if (keepAlive)
             {
                 buff.Append("keep-alive\r\n");
                 buff.Append("keep-alive: max=6, timeout=200\r\n");
@@ -145,32 +253,305 @@ namespace bre
             {
                 buff.Append("close\r\n");
             }
-            buff.Append("Content-type: " + getFileType() + "\r\n");
         }
 
-        void addContent(Buffer &buff)
+        // 缓存文件的校验器和 200 / 304 响应头部（长短连接各一份），第一次使用时生成，之后随缓存条目共享
+        // ETag 由 inode、大小和纳秒级修改时间组成，不读取文件内容；文件改动后缓存条目即被替换
+        static void prepare(const CachedFile &file)
         {
-            int srcFd = open((srcDir + path).data(), O_RDONLY);
+            std::call_once(file.headerOnce, [&file]
+                           {
+                               char etag[64];
+                               snprintf(etag, sizeof(etag), "\"%llx-%llx-%llx\"",
+                                        static_cast<unsigned long long>(file.st.st_ino),
+                                        static_cast<unsigned long long>(file.st.st_size),
+                                        static_cast<unsigned long long>(file.st.st_mtim.tv_sec) * 1000000000ULL +
+                                            file.st.st_mtim.tv_nsec);
+                               file.etag = etag;
+                               char modified[64];
+                               tm t{};
+                               gmtime_r(&file.st.st_mtime, &t);
+                               strftime(modified, sizeof(modified), "%a, %d %b %Y %H:%M:%S GMT", &t);
+                               file.validators = "ETag: " + file.etag + "\r\nLast-Modified: " + modified + "\r\n";
+                               const std::string &validators = file.validators;
+
+                               for (int alive = 0; alive < 2; ++alive)
+                               {
+                                   Buffer buff(256);
+                                   buff.Append("HTTP/1.1 200 OK\r\n");
+                                   addConnection(buff, alive);
+                                   buff.Append("Content-type: " + file.type + "\r\n");
+                                   buff.Append("Content-length: " + std::to_string(file.Size()) + "\r\n");
+                                   buff.Append("Accept-Ranges: bytes\r\n");
+                                   buff.Append(validators);
+                                   file.header[alive] = buff.RetrieveAll();
+
+                                   buff.Append("HTTP/1.1 304 Not Modified\r\n");
+                                   addConnection(buff, alive);
+                                   buff.Append(validators);
+                                   file.notModified[alive] = buff.RetrieveAll();
+                               } });
+        }
 
-            if (srcFd < 0)
+        // If-None-Match 优先（弱比较，* 匹配任意），没有时再比较 If-Modified-Since
+        bool notModified(const CachedFile &file) const
+        {
+            if (!ifNoneMatch.empty())
             {
-                ErrorContent(buff, "File NotFound!");
-                return;
+                return etagMatch(ifNoneMatch, file.etag);
             }
+            if (!ifModifiedSince.empty())
+            {
+                time_t since = parseHttpDate(ifModifiedSince);
+                return since >= 0 && file.st.st_mtime <= since;
+            }
+            return false;
+        }
 
-            Log::debug("file path {}", (srcDir + path).data());
+        // 没有 If-Range，或它与当前文件的 ETag（强比较）或 Last-Modified 一致时才按 Range 发送
+        bool ifRangeMatch(const CachedFile &file) const
+        {
+            if (ifRange.empty())
+            {
+                return true;
+            }
+            if (ifRange.front() == '"' || ifRange.starts_with("W/"))
+            {
+                return ifRange == file.etag;
+            }
+            return parseHttpDate(ifRange) == file.st.st_mtime;
+        }
 
-            // 使用mmap将文件映射到内存
-            int *mmRet = (int *)mmap(0, mmFileStat.st_size, PROT_READ, MAP_PRIVATE, srcFd, 0);
-            if (*mmRet == -1)
+        // 解析 bytes=a-b, c-, -n，按顺序得到可满足的闭区间 [first, last]
+        // 格式错误或超过 MAX_RANGES 个区间时返回 false（忽略 Range）；都不可满足时 count 为 0
+        static bool parseRange(std::string_view spec, size_t size,
+                               std::array<std::pair<size_t, size_t>, MAX_RANGES> &parts, size_t &count)
+        {
+            count = 0;
+            if (!spec.starts_with("bytes="))
+            {
+                return false;
+            }
+            spec.remove_prefix(6);
+            size_t specs = 0;
+            while (true)
+            {
+                size_t comma = spec.find(',');
+                std::string_view item = spec.substr(0, comma);
+                while (!item.empty() && (item.front() == ' ' || item.front() == '\t'))
+                {
+                    item.remove_prefix(1);
+                }
+                while (!item.empty() && (item.back() == ' ' || item.back() == '\t'))
+                {
+                    item.remove_suffix(1);
+                }
+                size_t dash = item.find('-');
+                if (dash == std::string_view::npos || ++specs > MAX_RANGES)
+                {
+                    return false;
+                }
+                size_t first = 0, last = 0;
+                bool hasFirst = parseNumber(item.substr(0, dash), first);
+                bool hasLast = parseNumber(item.substr(dash + 1), last);
+                if ((!hasFirst && dash != 0) || (!hasLast && dash + 1 != item.size()) || (!hasFirst && !hasLast) ||
+                    (hasFirst && hasLast && last < first))
+                {
+                    return false;
+                }
+                if (!hasFirst)
+                {
+                    // 最后 last 个字节
+                    if (last > 0 && size > 0)
+                    {
+                        parts[count++] = {size - std::min(last, size), size - 1};
+                    }
+                }
+                else if (first < size)
+                {
+                    parts[count++] = {first, hasLast ? std::min(last, size - 1) : size - 1};
+                }
+                if (comma == std::string_view::npos)
+                {
+                    return true;
+                }
+                spec.remove_prefix(comma + 1);
+            }
+        }
+
+        static bool parseNumber(std::string_view text, size_t &value)
+        {
+            if (text.empty() || text.size() > 18)
+            {
+                return false;
+            }
+            value = 0;
+            for (char c : text)
+            {
+                if (c < '0' || c > '9')
+                {
+                    return false;
+                }
+                value = value * 10 + (c - '0');
+            }
+            return true;
+        }
+
+        // 按 Range 生成 206 / 416 的完整头部；单个区间直接发送，多个区间用 multipart/byteranges
+        bool makeRanges(Buffer &buff)
+        {
+            std::array<std::pair<size_t, size_t>, MAX_RANGES> parts;
+            size_t count = 0;
+            if (!parseRange(range, file->Size(), parts, count))
+            {
+                return false;
+            }
+            std::string size = std::to_string(file->Size());
+            code = count == 0 ? 416 : 206;
+            addStateLine(buff);
+            addConnection(buff, isKeepAlive);
+            if (count == 0)
+            {
+                buff.Append("Content-Range: bytes */" + size + "\r\n");
+                buff.Append("Content-length: 0\r\n");
+                addDate(buff);
+                buff.Append("\r\n", 2);
+                return true;
+            }
+            if (count == 1)
+            {
+                auto [first, last] = parts[0];
+                buff.Append("Content-type: " + file->type + "\r\n");
+                buff.Append("Content-Range: bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" + size + "\r\n");
+                buff.Append("Content-length: " + std::to_string(last - first + 1) + "\r\n");
+                buff.Append(file->validators);
+                addDate(buff);
+                buff.Append("\r\n", 2);
+                addRange(buff.ReadableBytes(), first, last - first + 1);
+                return true;
+            }
+            // 每个区间前是分隔行和该区间的头部，最后是结束行
+            std::vector<std::string> delims(count);
+            size_t length = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto [first, last] = parts[i];
+                delims[i] = std::string("\r\n--") + BOUNDARY + "\r\nContent-type: " + file->type +
+                            "\r\nContent-Range: bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" + size +
+                            "\r\n\r\n";
+                length += delims[i].size() + last - first + 1;
+            }
+            std::string closing = std::string("\r\n--") + BOUNDARY + "--\r\n";
+            length += closing.size();
+            buff.Append(std::string("Content-type: multipart/byteranges; boundary=") + BOUNDARY + "\r\n");
+            buff.Append("Content-length: " + std::to_string(length) + "\r\n");
+            buff.Append(file->validators);
+            addDate(buff);
+            buff.Append("\r\n", 2);
+            for (size_t i = 0; i < count; ++i)
+            {
+                buff.Append(delims[i]);
+                addRange(buff.ReadableBytes(), parts[i].first, parts[i].second - parts[i].first + 1);
+            }
+            buff.Append(closing);
+            return true;
+        }
+
+        void addRange(size_t buffEnd, size_t offset, size_t len)
+        {
+            if (len > 0)
+            {
+                ranges.push_back({buffEnd, offset, len});
+            }
+        }
+
+        static bool etagMatch(std::string_view list, std::string_view etag)
+        {
+            while (!list.empty())
+            {
+                size_t comma = list.find(',');
+                std::string_view tag = list.substr(0, comma);
+                list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+                while (!tag.empty() && (tag.front() == ' ' || tag.front() == '\t'))
+                {
+                    tag.remove_prefix(1);
+                }
+                while (!tag.empty() && (tag.back() == ' ' || tag.back() == '\t'))
+                {
+                    tag.remove_suffix(1);
+                }
+                if (tag.starts_with("W/"))
+                {
+                    tag.remove_prefix(2);
+                }
+                if (tag == "*" || tag == etag)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // IMF-fixdate，如 Sun, 06 Nov 1994 08:49:37 GMT；格式不对时返回 -1
+        static time_t parseHttpDate(std::string_view date)
+        {
+            char text[64];
+            if (date.size() >= sizeof(text))
+            {
+                return -1;
+            }
+            date.copy(text, date.size());
+            text[date.size()] = '\0';
+            tm t{};
+            const char *end = strptime(text, "%a, %d %b %Y %H:%M:%S GMT", &t);
+            if (end == nullptr || *end != '\0')
+            {
+                return -1;
+            }
+            return timegm(&t);
+        }
+
+        // "Date: ...\r\n"，每个线程每秒格式化一次
+        static void addDate(Buffer &buff)
+        {
+            thread_local time_t last = -1;
+            thread_local char date[64];
+            thread_local size_t len = 0;
+            time_t now = time(nullptr);
+            if (now != last)
+            {
+                tm t{};
+                gmtime_r(&now, &t);
+                len = strftime(date, sizeof(date), "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &t);
+                last = now;
+            }
+            buff.Append(date, len);
+        }
+
+        void addContent(Buffer &buff)
+        {
+            if (code >= 400 && codePath.count(code) == 0)
+            {
+                // 没有错误页面的状态码（如 413），直接生成页面
+                ErrorContent(buff, codeStatus.find(code)->second);
+                return;
+            }
+            if (hasContent)
+            {
+                buff.Append("Content-length: " + std::to_string(content.size()) + "\r\n\r\n");
+                buff.Append(content);
+                return;
+            }
+            // 文件来自共享缓存，内容不拷贝到 buff，由 HttpConn 在头部之后发送
+            if (!file || !file->Readable())
             {
                 ErrorContent(buff, "File NotFound!");
                 return;
             }
-            mmFile = (char *)mmRet;
-            close(srcFd);
-            buff.Append("Content-length: " + std::to_string(mmFileStat.st_size) + "\r\n\r\n");
-            buff.Append(mmFile, mmFileStat.st_size);
+
+            Log::debug("file path {}", (srcDir + path).data());
+            buff.Append("Content-length: " + std::to_string(file->Size()) + "\r\n\r\n");
+            addRange(buff.ReadableBytes(), 0, file->Size());
         }
 
         void errorHtml()
@@ -178,24 +559,17 @@ namespace bre
             if (codePath.count(code) == 1)
             {
                 path = codePath.find(code)->second;
-                stat((srcDir + path).data(), &mmFileStat);
+                file = FileCache::Instance().Get(srcDir, path);
+            }
+            else if (code >= 400)
+            {
+                path = "/" + std::to_string(code) + ".html";
             }
         }
 
         std::string getFileType()
         {
-            // 文件后缀
-            std::string::size_type idx = path.find_last_of('.');
-            if (idx == std::string::npos)
-            {
-                return "text/plain";
-            }
-            std::string suffix = path.substr(idx);
-            if (suffixType.count(suffix) == 1)
-            {
-                return suffixType.find(suffix)->second;
-            }
-            return "text/plain";
+            return FileCache::TypeOf(path);
         }
 
         int code;
@@ -204,44 +578,32 @@ namespace bre
         std::string path;
         std::string srcDir;
 
-        char *mmFile = nullptr;
-        struct stat mmFileStat{};
+        std::shared_ptr<const CachedFile> file; // 消息体文件，发送完毕前保持引用
+        std::string_view block;                 // 指向 file 中预先生成的头部
+        std::string_view ifNoneMatch;           // 条件请求头，指向请求的缓冲区
+        std::string_view ifModifiedSince;
+        std::string_view range;
+        std::string_view ifRange;
+        std::vector<FileRange> ranges;          // 消息体中的文件片段，随响应对象复用
+
+
+        bool hasContent = false;
+        std::string content;
+        std::string contentType;
 
-        static const std::unordered_map<std::string, std::string> suffixType;
         static const std::unordered_map<int, std::string> codeStatus;
         static const std::unordered_map<int, std::string> codePath;
     };
 
-    const std::unordered_map<std::string, std::string> HttpResponse::suffixType{
-        {".html", "text/html"},
-        {".xml", "text/xml"},
-        {".xhtml", "application/xhtml+xml"},
-        {".html", "text/html"},
-        {".xml", "text/xml"},
-        {".xhtml", "application/xhtml+xml"},
-        {".txt", "text/plain"},
-        {".rtf", "application/rtf"},
-        {".pdf", "application/pdf"},
-        {".word", "application/nsword"},
-        {".png", "image/png"},
-        {".gif", "image/gif"},
-        {".jpg", "image/jpeg"},
-        {".jpeg", "image/jpeg"},
-        {".au", "audio/basic"},
-        {".mpeg", "video/mpeg"},
-        {".mpg", "video/mpeg"},
-        {".avi", "video/x-msvideo"},
-        {".gz", "application/x-gzip"},
-        {".tar", "application/x-tar"},
-        {".css", "text/css "},
-        {".js", "text/javascript "},
-    };
-
     const unordered_map<int, string> HttpResponse::codeStatus = {
         {200, "OK"},
+        {206, "Partial Content"},
+        {304, "Not Modified"},
         {400, "Bad Request"},
         {403, "Forbidden"},
         {404, "Not Found"},
+        {413, "Payload Too Large"},
+        {416, "Range Not Satisfiable"},
     };
 
     const unordered_map<int, string> HttpResponse::codePath = {
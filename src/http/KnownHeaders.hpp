@@ -0,0 +1,200 @@
+#ifndef KNOWN_HEADERS_HPP
+#define KNOWN_HEADERS_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace bre
+{
+
+    // 常用请求头，解析时直接放进 HttpRequest 的固定槽位，按 HeaderId 以数组下标读取
+    // 顺序与 KnownHeaders::NAMES 一致
+    enum class HeaderId : uint8_t
+    {
+        Host,
+        Connection,
+        ContentLength,
+        ContentType,
+        TransferEncoding,
+        Accept,
+        AcceptEncoding,
+        AcceptLanguage,
+        UserAgent,
+        Referer,
+        Cookie,
+        Authorization,
+        CacheControl,
+        IfNoneMatch,
+        IfModifiedSince,
+        IfMatch,
+        IfUnmodifiedSince,
+        IfRange,
+        Range,
+        Upgrade,
+        Expect,
+        Origin,
+        Count,
+        Unknown = 0xFF
+    };
+
+    // 编译期生成的完美哈希：在常量求值中搜索一个种子，使所有已知头部名落在不同的槽中
+    // 查找时由长度和首、中、尾字节算出 key 和槽位，key 相同时再比较完整的名字（不区分大小写）
+    // 新增的名字与已有的 key 相同时编译失败
+    class KnownHeaders
+    {
+    public:
+        static constexpr size_t COUNT = static_cast<size_t>(HeaderId::Count);
+
+        static constexpr std::array<std::string_view, COUNT> NAMES{
+            "Host", "Connection", "Content-Length", "Content-Type", "Transfer-Encoding",
+            "Accept", "Accept-Encoding", "Accept-Language", "User-Agent", "Referer",
+            "Cookie", "Authorization", "Cache-Control", "If-None-Match", "If-Modified-Since",
+            "If-Match", "If-Unmodified-Since", "If-Range", "Range", "Upgrade",
+            "Expect", "Origin"};
+
+        // name 须为 token（解析器已经检查过），这样逐字节 | 0x20 后与小写名字比较才准确
+        static HeaderId Lookup(std::string_view name)
+        {
+            uint32_t k = key(name);
+            size_t slot = hash(k, table.seed);
+            // 先比较槽中记录的 key，多数未知头部在这里就被排除
+            if (table.keys[slot] != k || table.slots[slot] == EMPTY ||
+                !equalsLower(name, LOWER[table.slots[slot]].data()))
+            {
+                return HeaderId::Unknown;
+            }
+            return static_cast<HeaderId>(table.slots[slot]);
+        }
+
+        static constexpr std::string_view Name(HeaderId id)
+        {
+            return NAMES[static_cast<size_t>(id)];
+        }
+
+    private:
+        static constexpr int BITS = 6;
+        static constexpr size_t SLOTS = size_t(1) << BITS;
+        static constexpr uint8_t EMPTY = 0xFF;
+
+        struct Table
+        {
+            uint32_t seed;
+            std::array<uint8_t, SLOTS> slots;
+            std::array<uint32_t, SLOTS> keys;
+        };
+
+        // 长度和首、中、尾三个字节（c | 0x20 把字母转成小写，'-' 不变）拼成的 key
+        static constexpr uint32_t key(std::string_view s)
+        {
+            if (s.empty() || s.size() > 0xFF)
+            {
+                return 0;
+            }
+            return static_cast<uint32_t>(s.size()) << 24 |
+                   static_cast<uint32_t>(static_cast<uint8_t>(s.front() | 0x20)) << 16 |
+                   static_cast<uint32_t>(static_cast<uint8_t>(s[s.size() / 2] | 0x20)) << 8 |
+                   static_cast<uint8_t>(s.back() | 0x20);
+        }
+
+        // 乘法散列后取高位，只需一次乘法
+        static constexpr size_t hash(uint32_t key, uint32_t seed)
+        {
+            return ((key ^ seed) * 0x9E3779B1u) >> (32 - BITS);
+        }
+
+        static constexpr Table build()
+        {
+            for (uint32_t seed = 2166136261u;; ++seed)
+            {
+                Table t{seed, {}, {}};
+                t.slots.fill(EMPTY);
+                bool ok = true;
+                for (size_t i = 0; i < COUNT && ok; ++i)
+                {
+                    size_t slot = hash(key(NAMES[i]), seed);
+                    ok = t.slots[slot] == EMPTY;
+                    t.slots[slot] = static_cast<uint8_t>(i);
+                    t.keys[slot] = key(NAMES[i]);
+                }
+                if (ok)
+                {
+                    return t;
+                }
+            }
+        }
+
+        // 小写的名字，补零到 8 的倍数，供 equalsLower 按 8 字节读取
+        static constexpr size_t MAX_NAME = 24;
+
+        static constexpr std::array<std::array<char, MAX_NAME>, COUNT> makeLower()
+        {
+            std::array<std::array<char, MAX_NAME>, COUNT> lower{};
+            for (size_t i = 0; i < COUNT; ++i)
+            {
+                for (size_t j = 0; j < NAMES[i].size(); ++j)
+                {
+                    lower[i][j] = static_cast<char>(NAMES[i][j] | 0x20);
+                }
+            }
+            return lower;
+        }
+
+        static uint64_t load(const char *p)
+        {
+            uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        // 长度相同的前提下比较；8 字节以上的名字按字比较，最后一个字与前面的重叠
+        static bool equalsLower(std::string_view name, const char *lower)
+        {
+            const uint64_t mask = 0x2020202020202020ull;
+            const char *p = name.data();
+            size_t n = name.size();
+            if (n < 8)
+            {
+                for (size_t i = 0; i < n; ++i)
+                {
+                    if ((p[i] | 0x20) != lower[i])
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            for (size_t i = 0; i + 8 <= n; i += 8)
+            {
+                if ((load(p + i) | mask) != load(lower + i))
+                {
+                    return false;
+                }
+            }
+            return (load(p + n - 8) | mask) == load(lower + n - 8);
+        }
+
+        static const std::array<std::array<char, MAX_NAME>, COUNT> LOWER;
+        static const Table table;
+
+        static_assert(COUNT < EMPTY && COUNT <= SLOTS);
+        static_assert([]
+                      {
+                          for (auto name : NAMES)
+                          {
+                              if (name.size() >= MAX_NAME)
+                              {
+                                  return false;
+                              }
+                          }
+                          return true;
+                      }());
+    };
+
+    inline constexpr std::array<std::array<char, KnownHeaders::MAX_NAME>, KnownHeaders::COUNT>
+        KnownHeaders::LOWER = KnownHeaders::makeLower();
+    inline constexpr KnownHeaders::Table KnownHeaders::table = KnownHeaders::build();
+
+} // namespace bre
+#endif // KNOWN_HEADERS_HPP
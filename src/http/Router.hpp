@@ -0,0 +1,447 @@
+#ifndef ROUTER_HPP
+#define ROUTER_HPP
+
+#include "HttpRequest.hpp"
+#include "HttpResponse.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace bre
+{
+    class Router;
+    struct Route;
+
+    // 一次匹配的结果：命中的路由、按出现顺序的参数值，前缀路由还有剩余部分
+    struct RouteMatch
+    {
+        static const size_t MAX_PARAMS = 8;
+
+        const Route *route = nullptr;
+        std::array<std::string_view, MAX_PARAMS> params{};
+        size_t paramCount = 0;
+        std::string_view rest; // 前缀路由 /a/* 中 * 匹配到的部分
+
+        std::string_view Param(std::string_view name) const;
+    };
+
+    // 路由处理器：在 MakeResponse 之前按请求填写响应，默认发送请求路径对应的文件
+    // 所有反应堆线程共享同一个处理器对象，Handle 不能修改自身状态
+    class HttpHandler
+    {
+    public:
+        virtual ~HttpHandler() = default;
+        virtual void Handle(HttpRequest &request, const RouteMatch &match, HttpResponse &response) const = 0;
+        // Handle 是否可能阻塞（如查询数据库）：是则不在反应堆线程内调用
+        virtual bool MayBlock(const HttpRequest &) const { return false; }
+        // 头部解析完、消息体到达之前调用，match 中的 view 只在调用期间有效
+        // 返回非空时本请求的消息体按块交给它，不收集到 request.Body()（表单除外），连接占用的内存与消息体大小无关
+        // 默认返回空：消息体收集到 Body() 中供 Handle 读取
+        virtual HttpRequest::BodyHandler BodySink(HttpRequest &, const RouteMatch &) const { return nullptr; }
+
+        // 不使用消息体的处理器用它丢弃消息体
+        static HttpRequest::BodyHandler DiscardBody()
+        {
+            return [](std::string_view) {};
+        }
+    };
+
+    struct Route
+    {
+        std::string pattern;
+        bool prefix = false;
+        std::vector<std::string> paramNames;
+        std::unique_ptr<HttpHandler> handler;
+        mutable std::atomic<uint64_t> hits{0};
+    };
+
+    inline std::string_view RouteMatch::Param(std::string_view name) const
+    {
+        for (size_t i = 0; i < paramCount; ++i)
+        {
+            if (route->paramNames[i] == name)
+            {
+                return params[i];
+            }
+        }
+        return {};
+    }
+
+    // 静态文件：target 为空时发送请求路径本身；否则发送 target，前缀路由再接上剩余部分
+    class StaticHandler : public HttpHandler
+    {
+    public:
+        explicit StaticHandler(std::string_view target) : target(target) {}
+
+        HttpRequest::BodyHandler BodySink(HttpRequest &, const RouteMatch &) const override
+        {
+            return DiscardBody();
+        }
+
+        void Handle(HttpRequest &, const RouteMatch &match, HttpResponse &response) const override
+        {
+            if (target.empty())
+            {
+                return;
+            }
+            if (match.route->prefix)
+            {
+                response.SetPath(target + std::string(match.rest));
+            }
+            else
+            {
+                response.SetPath(target);
+            }
+        }
+
+    private:
+        std::string target;
+    };
+
+    // 登录注册：表单 POST 查询 MySQL 后跳转到欢迎页或错误页，其他请求发送 page
+    class AuthHandler : public HttpHandler
+    {
+    public:
+        AuthHandler(bool isLogin, std::string_view page) : isLogin(isLogin), page(page) {}
+
+        // 只有提交表单时才查询 MySQL，GET 只返回页面
+        bool MayBlock(const HttpRequest &request) const override
+        {
+            return request.Method() == "POST";
+        }
+
+        // 只用到表单，表单总会收集（见 HttpRequest::beginBody），其余消息体丢弃
+        HttpRequest::BodyHandler BodySink(HttpRequest &, const RouteMatch &) const override
+        {
+            return DiscardBody();
+        }
+
+        void Handle(HttpRequest &request, const RouteMatch &, HttpResponse &response) const override
+        {
+            if (request.Method() == "POST" &&
+                request.GetHeader(HeaderId::ContentType) == "application/x-www-form-urlencoded")
+            {
+                bool ok = request.userVerify(std::string(request.GetPost("username")),
+                                             std::string(request.GetPost("password")), isLogin);
+                response.SetPath(ok ? "/welcome.html" : "/error.html");
+            }
+            else
+            {
+                response.SetPath(page);
+            }
+        }
+
+    private:
+        bool isLogin;
+        std::string page;
+    };
+
+    // 每条路由的命中次数，文本格式
+    class MetricsHandler : public HttpHandler
+    {
+    public:
+        explicit MetricsHandler(const Router &router) : router(router) {}
+
+        void Handle(HttpRequest &, const RouteMatch &, HttpResponse &response) const override;
+
+        HttpRequest::BodyHandler BodySink(HttpRequest &, const RouteMatch &) const override
+        {
+            return DiscardBody();
+        }
+
+    private:
+        const Router &router;
+    };
+
+    // 路由表：按 '/' 分段的前缀树，每个节点的静态子段放在哈希表中
+    // 匹配时逐段查找，耗时只与路径段数有关，与路由数量无关
+    // 优先级：静态段 > 参数段（:name）> 前缀（*，只能是最后一段）；静态段走不通时回退到参数段和前缀
+    // 路由在服务器启动前注册，之后只读，可被所有反应堆线程并发匹配
+    class Router
+    {
+    public:
+        enum class HandlerKind
+        {
+            Static,
+            Login,
+            Register,
+            Metrics
+        };
+
+        struct RouteSpec
+        {
+            std::string_view pattern;
+            HandlerKind kind;
+            std::string_view target;
+        };
+
+        // 内置路由，编译期检查格式和重复
+        static const std::array<RouteSpec, 11> BUILTIN_ROUTES;
+
+        Router()
+        {
+            nodes.emplace_back();
+        }
+
+        explicit Router(std::span<const RouteSpec> specs) : Router()
+        {
+            for (const RouteSpec &spec : specs)
+            {
+                switch (spec.kind)
+                {
+                case HandlerKind::Static:
+                    Add(spec.pattern, std::make_unique<StaticHandler>(spec.target));
+                    break;
+                case HandlerKind::Login:
+                    Add(spec.pattern, std::make_unique<AuthHandler>(true, spec.target));
+                    break;
+                case HandlerKind::Register:
+                    Add(spec.pattern, std::make_unique<AuthHandler>(false, spec.target));
+                    break;
+                case HandlerKind::Metrics:
+                    Add(spec.pattern, std::make_unique<MetricsHandler>(*this));
+                    break;
+                }
+            }
+        }
+
+        Router(const Router &) = delete;
+        Router &operator=(const Router &) = delete;
+
+        // 内置路由之外的路由须在启动服务器之前添加
+        static Router &Instance()
+        {
+            static Router instance(BUILTIN_ROUTES);
+            return instance;
+        }
+
+        // pattern 如 /login、/user/:id/profile、/static/*，格式错误或重复时抛出 invalid_argument
+        void Add(std::string_view pattern, std::unique_ptr<HttpHandler> handler)
+        {
+            if (!ValidPattern(pattern) || !handler)
+            {
+                throw std::invalid_argument("invalid route: " + std::string(pattern));
+            }
+            auto route = std::make_unique<Route>();
+            route->pattern.assign(pattern);
+            route->handler = std::move(handler);
+
+            uint32_t idx = 0;
+            std::string_view rest = pattern.substr(1);
+            while (true)
+            {
+                size_t slash = rest.find('/');
+                std::string_view seg = rest.substr(0, slash);
+                if (seg == "*")
+                {
+                    route->prefix = true;
+                    break;
+                }
+                if (!seg.empty() && seg[0] == ':')
+                {
+                    if (nodes[idx].param == NONE)
+                    {
+                        uint32_t child = static_cast<uint32_t>(nodes.size());
+                        nodes.emplace_back();
+                        nodes[idx].param = child;
+                    }
+                    route->paramNames.emplace_back(seg.substr(1));
+                    idx = nodes[idx].param;
+                }
+                else
+                {
+                    auto it = nodes[idx].children.find(seg);
+                    if (it == nodes[idx].children.end())
+                    {
+                        uint32_t child = static_cast<uint32_t>(nodes.size());
+                        nodes.emplace_back();
+                        it = nodes[idx].children.emplace(std::string(seg), child).first;
+                    }
+                    idx = it->second;
+                }
+                if (slash == std::string_view::npos)
+                {
+                    break;
+                }
+                rest.remove_prefix(slash + 1);
+            }
+
+            const Route *&slot = route->prefix ? nodes[idx].prefix : nodes[idx].exact;
+            if (slot != nullptr)
+            {
+                throw std::invalid_argument("duplicate route: " + std::string(pattern));
+            }
+            slot = route.get();
+            routes.push_back(std::move(route));
+        }
+
+        // 找不到时返回 false；根前缀 /* 存在时总能找到
+        bool Match(std::string_view path, RouteMatch &match) const
+        {
+            if (!Peek(path, match))
+            {
+                return false;
+            }
+            match.route->hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // 与 Match 相同但不计入 hits：头部解析完时先用它确定消息体交给谁，请求完整后再 Match
+        bool Peek(std::string_view path, RouteMatch &match) const
+        {
+            match.paramCount = 0;
+            match.rest = {};
+            if (path.empty() || path[0] != '/')
+            {
+                match.route = nullptr;
+                return false;
+            }
+            match.route = find(0, path.substr(1), match);
+            return match.route != nullptr;
+        }
+
+        const std::vector<std::unique_ptr<Route>> &Routes() const
+        {
+            return routes;
+        }
+
+        // 以 '/' 开头；'*' 只能单独作为最后一段；':' 开头的参数段须有名字，最多 MAX_PARAMS 个
+        static constexpr bool ValidPattern(std::string_view pattern)
+        {
+            if (pattern.empty() || pattern[0] != '/')
+            {
+                return false;
+            }
+            size_t params = 0;
+            size_t pos = 1;
+            while (true)
+            {
+                size_t slash = pattern.find('/', pos);
+                std::string_view seg = pattern.substr(pos, slash == std::string_view::npos ? slash : slash - pos);
+                if (seg.find('*') != std::string_view::npos && (seg != "*" || slash != std::string_view::npos))
+                {
+                    return false;
+                }
+                if (!seg.empty() && seg[0] == ':' && (seg.size() == 1 || ++params > RouteMatch::MAX_PARAMS))
+                {
+                    return false;
+                }
+                if (slash == std::string_view::npos)
+                {
+                    return true;
+                }
+                pos = slash + 1;
+            }
+        }
+
+    private:
+        static const uint32_t NONE = UINT32_MAX;
+
+        struct Node
+        {
+            std::unordered_map<std::string, uint32_t, StringHash, StringEqual> children; // 静态段
+            uint32_t param = NONE;        // 参数段子节点
+            const Route *exact = nullptr; // 到此结束的路由
+            const Route *prefix = nullptr; // 以此为前缀的 /* 路由
+        };
+
+        // rest 为当前节点之后的路径（不含开头的 '/'）
+        const Route *find(uint32_t idx, std::string_view rest, RouteMatch &m) const
+        {
+            const Node &node = nodes[idx];
+            size_t slash = rest.find('/');
+            std::string_view seg = rest.substr(0, slash);
+            bool last = slash == std::string_view::npos;
+
+            auto it = node.children.find(seg);
+            if (it != node.children.end())
+            {
+                const Route *route = last ? nodes[it->second].exact : find(it->second, rest.substr(slash + 1), m);
+                if (route != nullptr)
+                {
+                    return route;
+                }
+            }
+            if (node.param != NONE && !seg.empty() && m.paramCount < RouteMatch::MAX_PARAMS)
+            {
+                size_t count = m.paramCount;
+                m.params[m.paramCount++] = seg;
+                const Route *route = last ? nodes[node.param].exact : find(node.param, rest.substr(slash + 1), m);
+                if (route != nullptr)
+                {
+                    return route;
+                }
+                m.paramCount = count;
+            }
+            if (node.prefix != nullptr)
+            {
+                m.rest = rest;
+                return node.prefix;
+            }
+            return nullptr;
+        }
+
+        std::vector<Node> nodes; // nodes[0] 为根
+        std::vector<std::unique_ptr<Route>> routes;
+    };
+
+    // 原来 parsePath 中的默认页面和登录注册，最后由 /* 发送请求路径对应的文件
+    inline constexpr std::array<Router::RouteSpec, 11> Router::BUILTIN_ROUTES{{
+        {"/", HandlerKind::Static, "/index.html"},
+        {"/index", HandlerKind::Static, "/index.html"},
+        {"/welcome", HandlerKind::Static, "/welcome.html"},
+        {"/video", HandlerKind::Static, "/video.html"},
+        {"/picture", HandlerKind::Static, "/picture.html"},
+        {"/login", HandlerKind::Login, "/login.html"},
+        {"/login.html", HandlerKind::Login, "/login.html"},
+        {"/register", HandlerKind::Register, "/register.html"},
+        {"/register.html", HandlerKind::Register, "/register.html"},
+        {"/metrics", HandlerKind::Metrics, ""},
+        {"/*", HandlerKind::Static, ""},
+    }};
+
+    static_assert([]
+                  {
+                      const auto &routes = Router::BUILTIN_ROUTES;
+                      for (size_t i = 0; i < routes.size(); ++i)
+                      {
+                          if (!Router::ValidPattern(routes[i].pattern))
+                          {
+                              return false;
+                          }
+                          for (size_t j = 0; j < i; ++j)
+                          {
+                              if (routes[i].pattern == routes[j].pattern)
+                              {
+                                  return false;
+                              }
+                          }
+                      }
+                      return true;
+                  }(),
+                  "invalid or duplicate built-in route");
+
+    inline void MetricsHandler::Handle(HttpRequest &, const RouteMatch &, HttpResponse &response) const
+    {
+        std::string body;
+        uint64_t total = 0;
+        for (const auto &route : router.Routes())
+        {
+            uint64_t hits = route->hits.load(std::memory_order_relaxed);
+            total += hits;
+            body += "route_requests{route=\"" + route->pattern + "\"} " + std::to_string(hits) + "\n";
+        }
+        body = "requests_total " + std::to_string(total) + "\n" + body;
+        response.SetContent(std::move(body), "text/plain");
+    }
+
+} // namespace bre
+#endif // ROUTER_HPP
@@ -0,0 +1,285 @@
+// 请求解析性能测试：手写状态机解析器 vs 旧版正则解析器（单线程，即每核吞吐）
+// 请求样本为 HttpRequest.hpp 注释中的 Chrome/Edge 请求
+// g++ -std=c++20 -O2 benchHttpRequest.cpp -o benchHttpRequest -lmysqlcppconn
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include "HttpRequest.hpp"
+#include "Router.hpp"
+
+using namespace bre;
+
+// 统计全局 operator new/delete 调用次数，检查解析路径上的堆分配
+static size_t newCount = 0, deleteCount = 0;
+void* operator new(size_t size) {
+    ++newCount;
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {
+    if (p) {
+        ++deleteCount;
+    }
+    std::free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    if (p) {
+        ++deleteCount;
+    }
+    std::free(p);
+}
+
+// 旧版实现，仅用于对比：每行一次 RetrieveUntil（两次整段拷贝）加一次 std::regex 构造与匹配
+// 去掉了原来逐行打印到 cout 的部分
+class RegexRequest {
+public:
+    bool Parse(Buffer &buff) {
+        state = 0;
+        header.clear();
+        while (buff.ReadableBytes() && state != 3) {
+            std::string line = retrieveUntil(buff, "\r\n");
+            line = line.substr(0, line.size() - 2);
+            if (state == 0) {
+                std::regex patten("^([^ ]*) ([^ ]*) HTTP/([^ ]*)$");
+                std::smatch subMatch;
+                if (!std::regex_match(line, subMatch, patten)) {
+                    return false;
+                }
+                method = subMatch[1];
+                path = subMatch[2];
+                version = subMatch[3];
+                state = 1;
+            } else if (state == 1) {
+                std::regex patten("^([^:]*): ?(.*)$");
+                std::smatch subMatch;
+                if (std::regex_match(line, subMatch, patten)) {
+                    header[subMatch[1]] = subMatch[2];
+                } else {
+                    state = 2;
+                }
+            } else {
+                body = line;
+                state = 3;
+            }
+        }
+        return true;
+    }
+
+    std::string method, path, version, body;
+    std::unordered_map<std::string, std::string> header;
+
+private:
+    static std::string retrieveUntil(Buffer &buff, const std::string &end) {
+        const std::size_t pos = std::string(buff.Peek(), buff.Peek() + buff.ReadableBytes()).find(end);
+        if (pos == std::string::npos) {
+            if (std::string(buff.Peek(), buff.Peek() + buff.ReadableBytes()).find("\n") == std::string::npos) {
+                return buff.Retrieve(buff.ReadableBytes());
+            }
+            return "";
+        }
+        return buff.Retrieve(pos + end.size());
+    }
+
+    int state = 0;
+};
+
+const char REQUEST[] =
+    "GET /images/6.jpg HTTP/1.1\r\n"
+    "Host: 127.0.0.1:5678\r\n"
+    "Connection: keep-alive\r\n"
+    "sec-ch-ua-platform: \"Windows\"\r\n"
+    "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/131.0.0.0 Safari/537.36 Edg/131.0.0.0\r\n"
+    "sec-ch-ua: \"Microsoft Edge\";v=\"131\", \"Chromium\";v=\"131\", \"Not_A Brand\";v=\"24\"\r\n"
+    "DNT: 1\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "Accept: image/avif,image/webp,image/apng,image/svg+xml,image/*,*/*;q=0.8\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: no-cors\r\n"
+    "Sec-Fetch-Dest: image\r\n"
+    "Referer: http://127.0.0.1:5678/index.html\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8,en-GB;q=0.7,en-US;q=0.6\r\n"
+    "\r\n";
+
+// urlencoded 表单：解析后读取字段（按需切分并解码）；form/2 为请求头和消息体分两次到达
+const char FORM_HEAD[] =
+    "POST /submit HTTP/1.1\r\n"
+    "Host: 127.0.0.1:5678\r\n"
+    "Connection: keep-alive\r\n"
+    "X-Requested-With: XMLHttpRequest\r\n"
+    "X-Request-Id: 3f1c2a9e-8b7d-4e6f-a5c4-1d2e3f4a5b6c\r\n"
+    "Content-Type: application/x-www-form-urlencoded\r\n"
+    "Content-Length: 87\r\n"
+    "\r\n";
+const char FORM_BODY[] = "username=some+user&password=p%40ssw0rd&remember=on&comment=hello%20world%20from%20bench";
+
+// 每个请求的 operator new/delete 次数（预热后计数）
+template<typename Func>
+void countAllocations(const char *name, int iterations, Func &&parseOnce) {
+    Buffer buff(4096);
+    parseOnce(buff);
+    size_t news = newCount, deletes = deleteCount;
+    for (int i = 0; i < iterations; ++i) {
+        parseOnce(buff);
+    }
+    std::cout << std::setw(10) << name << std::setw(10) << std::setprecision(2)
+              << double(newCount - news) / iterations << " new/req"
+              << std::setw(10) << double(deleteCount - deletes) / iterations << " delete/req\n";
+}
+
+template<typename Func>
+double bench(int iterations, Func &&parseOnce) {
+    Buffer buff(4096);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        buff.Append(REQUEST, sizeof(REQUEST) - 1);
+        parseOnce(buff);
+        buff.Advance(buff.ReadableBytes());
+    }
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return iterations / d.count();
+}
+
+// 路由匹配：内置路由表与再加 1000 条路由后的对比，耗时只应与路径段数有关
+double benchRoute(int iterations, const Router &router) {
+    const std::string_view paths[] = {"/", "/login", "/images/6.jpg", "/metrics", "/api/v3/item7/42"};
+    RouteMatch match;
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        found += router.Match(paths[i % 5], match);
+    }
+    asm volatile("" : : "r"(found) : "memory");
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return iterations / d.count();
+}
+
+// 按行切分一遍请求（只调用 findCtl），对比各个指令集实现的扫描速度
+double benchScan(int iterations, const Scan::Ops &ops) {
+    const char *begin = REQUEST;
+    const char *end = REQUEST + sizeof(REQUEST) - 1;
+    size_t lines = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (const char *p = begin; p < end; ++p) {
+            p = ops.findCtl(p, end);
+            ++lines;
+        }
+        asm volatile("" : : "r"(lines) : "memory");
+    }
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return iterations * double(end - begin) / d.count() / 1e9;
+}
+
+int main() {
+    RegexRequest regexRequest;
+    double regexRate = bench(20000, [&](Buffer &buff) { regexRequest.Parse(buff); });
+
+    HttpRequest request;
+    size_t headers = 0;
+    double fsmRate = bench(2000000, [&](Buffer &buff) {
+        request.Init();
+        request.Parse(buff);
+        headers += request.HeaderCount();
+    });
+
+    // 每次只到达 16 字节：断点续解析，总工作量与整段到达时相当
+    double fragmentRate = 0;
+    {
+        Buffer buff(4096);
+        const size_t size = sizeof(REQUEST) - 1;
+        const int iterations = 1000000;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            for (size_t pos = 0; pos < size; pos += 16) {
+                buff.Append(REQUEST + pos, std::min<size_t>(16, size - pos));
+                request.Parse(buff);
+            }
+        }
+        std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+        fragmentRate = iterations / d.count();
+    }
+
+    // 登录表单：解析请求并读取用户名和密码
+    double formRate = 0;
+    {
+        Buffer buff(4096);
+        const int iterations = 1000000;
+        size_t length = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            buff.Append(FORM_HEAD, sizeof(FORM_HEAD) - 1);
+            buff.Append(FORM_BODY, sizeof(FORM_BODY) - 1);
+            request.Parse(buff);
+            length += request.GetPost("username").size() + request.GetPost("password").size();
+            buff.Advance(buff.ReadableBytes());
+        }
+        asm volatile("" : : "r"(length) : "memory");
+        std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+        formRate = iterations / d.count();
+    }
+
+    std::cout << "request size: " << sizeof(REQUEST) - 1 << " bytes, headers: " << headers / 2000000 << "\n"
+              << std::fixed << std::setprecision(0)
+              << std::setw(10) << "regex" << std::setw(14) << regexRate << " req/s\n"
+              << std::setw(10) << "fsm" << std::setw(14) << fsmRate << " req/s\n"
+              << std::setw(10) << "fsm/16B" << std::setw(14) << fragmentRate << " req/s\n"
+              << std::setw(10) << "form" << std::setw(14) << formRate << " req/s\n"
+              << std::setprecision(1) << "speedup: " << fsmRate / regexRate << "x\n"
+              << "scan: " << Scan::IsaName(Scan::Selected()) << "\n";
+    for (Scan::Isa isa : {Scan::Isa::Scalar, Scan::Isa::Sse42, Scan::Isa::Avx2}) {
+        if (!Scan::Supported(isa)) {
+            continue;
+        }
+        std::cout << std::setw(10) << Scan::IsaName(isa) << std::setw(14) << std::setprecision(2)
+                  << benchScan(2000000, Scan::OpsFor(isa)) << " GB/s\n";
+    }
+
+    Router builtin(Router::BUILTIN_ROUTES);
+    Router many(Router::BUILTIN_ROUTES);
+    for (int i = 0; i < 500; ++i) {
+        std::string item = "/api/v" + std::to_string(i % 5) + "/item" + std::to_string(i);
+        many.Add(item, std::make_unique<StaticHandler>(""));
+        many.Add(item + "/:id", std::make_unique<StaticHandler>(""));
+    }
+    std::cout << "route:\n" << std::setprecision(0)
+              << std::setw(10) << "builtin" << std::setw(14) << benchRoute(5000000, builtin) << " match/s\n"
+              << std::setw(10) << "+1000" << std::setw(14) << benchRoute(5000000, many) << " match/s\n";
+
+    std::cout << "allocations:\n";
+    countAllocations("regex", 1000, [&](Buffer &buff) {
+        buff.Append(REQUEST, sizeof(REQUEST) - 1);
+        regexRequest.Parse(buff);
+        buff.Advance(buff.ReadableBytes());
+    });
+    countAllocations("fsm", 100000, [&](Buffer &buff) {
+        buff.Append(REQUEST, sizeof(REQUEST) - 1);
+        request.Parse(buff);
+        buff.Advance(buff.ReadableBytes());
+    });
+    countAllocations("form", 100000, [&](Buffer &buff) {
+        buff.Append(FORM_HEAD, sizeof(FORM_HEAD) - 1);
+        buff.Append(FORM_BODY, sizeof(FORM_BODY) - 1);
+        request.Parse(buff);
+        request.GetPost("comment");
+        buff.Advance(buff.ReadableBytes());
+    });
+    countAllocations("form/2", 100000, [&](Buffer &buff) {
+        buff.Append(FORM_HEAD, sizeof(FORM_HEAD) - 1);
+        request.Parse(buff);
+        buff.Append(FORM_BODY, sizeof(FORM_BODY) - 1);
+        request.Parse(buff);
+        request.GetPost("comment");
+        buff.Advance(buff.ReadableBytes());
+    });
+    std::cout << std::flush;
+    return 0;
+}
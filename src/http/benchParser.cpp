@@ -0,0 +1,122 @@
+// 解析器吞吐：把 corpus 目录中录制的请求读入内存，不经过 socket 反复解析，输出 MB/s 和 req/s
+// 以 bad- 开头的文件应解析出错，其余文件中的请求（可以是流水线的多个）应全部解析完成
+// 用法：./benchParser [corpus 目录] [最低 MB/s]，结果不对或低于下限时返回 1，用作解析器改动的门槛
+// g++ -std=c++20 -O2 benchParser.cpp -o benchParser -lmysqlcppconn
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "HttpRequest.hpp"
+
+using namespace bre;
+
+struct Sample {
+    std::string name;
+    std::string data;
+    bool bad;
+};
+
+// 与一个连接上的处理相同：解析出所有完整的请求，出错则丢弃剩余数据
+size_t parseAll(HttpRequest &request, Buffer &buff, const Sample &sample, bool &error) {
+    size_t count = 0;
+    error = false;
+    buff.Append(sample.data.data(), sample.data.size());
+    while (buff.ReadableBytes() > 0) {
+        HttpRequest::ParseResult ret = request.Parse(buff);
+        if (ret == HttpRequest::ParseResult::Complete) {
+            ++count;
+        } else {
+            error = ret != HttpRequest::ParseResult::Incomplete;
+            break;
+        }
+    }
+    buff.Advance(buff.ReadableBytes());
+    request.Init();
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    std::filesystem::path dir = argc > 1 ? argv[1] : "corpus";
+    double minRate = argc > 2 ? std::stod(argv[2]) : 0;
+    Log::Instance().SetLevel(LogLevel::OFF);   // bad- 样本不写日志文件
+
+    std::vector<Sample> samples;
+    for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        std::ifstream in(entry.path(), std::ios::binary);
+        std::ostringstream ss;
+        ss << in.rdbuf();
+        std::string name = entry.path().filename().string();
+        samples.push_back({name, ss.str(), name.rfind("bad-", 0) == 0});
+    }
+    if (samples.empty()) {
+        std::cerr << "no samples in " << dir << "\n";
+        return 1;
+    }
+    std::sort(samples.begin(), samples.end(), [](const Sample &a, const Sample &b) { return a.name < b.name; });
+
+    // 先检查一遍结果，同时统计一轮的字节数和请求数
+    HttpRequest request;
+    Buffer buff(4096);
+    size_t bytes = 0, requests = 0;
+    bool ok = true;
+    for (const Sample &sample : samples) {
+        bool error = false;
+        size_t count = parseAll(request, buff, sample, error);
+        std::cout << std::setw(24) << sample.name << std::setw(8) << sample.data.size() << " bytes"
+                  << std::setw(4) << count << " requests" << (error ? "  error" : "") << "\n";
+        if (error != sample.bad || (!sample.bad && count == 0)) {
+            std::cerr << sample.name << ": unexpected result\n";
+            ok = false;
+        }
+        bytes += sample.data.size();
+        requests += count;
+    }
+    if (!ok) {
+        return 1;
+    }
+
+    // 每轮约 64 MB，取 5 轮的中位数
+    const int rounds = 5;
+    const size_t iterations = std::max<size_t>(1, (64 << 20) / bytes);
+    std::vector<double> seconds;
+    for (int r = 0; r < rounds; ++r) {
+        size_t parsed = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            for (const Sample &sample : samples) {
+                bool error;
+                parsed += parseAll(request, buff, sample, error);
+            }
+        }
+        std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+        if (parsed != requests * iterations) {
+            std::cerr << "request count changed between rounds\n";
+            return 1;
+        }
+        seconds.push_back(d.count());
+    }
+    std::sort(seconds.begin(), seconds.end());
+    double median = seconds[rounds / 2];
+    double mbps = bytes * iterations / median / (1 << 20);
+    double rps = requests * iterations / median;
+
+    std::cout << "scan: " << Scan::IsaName(Scan::Selected()) << ", " << samples.size() << " samples, "
+              << bytes << " bytes, " << requests << " requests per pass\n"
+              << std::fixed << std::setprecision(1)
+              << std::setw(12) << mbps << " MB/s\n"
+              << std::setprecision(0)
+              << std::setw(12) << rps << " req/s\n";
+    if (mbps < minRate) {
+        std::cerr << "below " << minRate << " MB/s\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+// libFuzzer 入口：覆盖 HttpRequest::Parse（整段到达与分段到达）、parseFromUrlencoded 和 GetQuery
+// clang++ -std=c++20 -g -O1 -fsanitize=fuzzer,address,undefined fuzzHttpRequest.cpp -o fuzzHttpRequest -lmysqlcppconn
+// ./fuzzHttpRequest fuzz-corpus corpus
+// 没有 clang 时加 -DFUZZ_REPLAY 用 g++ 编译，逐个重放命令行给出的文件（复现崩溃用）
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "HttpRequest.hpp"
+
+using namespace bre;
+
+namespace {
+
+// 逐字节读一遍，ASan 据此检查 view 是否指向已释放或整理前的缓冲区
+size_t touch(std::string_view s) {
+    size_t sum = 0;
+    for (char c : s) {
+        sum += static_cast<unsigned char>(c);
+    }
+    return sum;
+}
+
+void checkComplete(HttpRequest &request) {
+    assert(!request.Method().empty() && !request.Version().empty());
+    size_t sum = touch(request.Method()) + touch(request.Path()) + touch(request.Query()) +
+                 touch(request.Version()) + touch(request.Body());
+    size_t count = 0;
+    request.ForEachHeader([&](std::string_view key, std::string_view value) {
+        assert(!key.empty());
+        sum += touch(key) + touch(value);
+        ++count;
+    });
+    assert(count == request.HeaderCount());
+    // 按需解析表单和查询参数
+    sum += touch(request.GetPost("username")) + touch(request.GetQuery("q"));
+    for (const auto &[key, value] : request.post) {
+        sum += touch(key) + touch(value);
+    }
+    for (const auto &[key, value] : request.queryFields) {
+        sum += touch(key) + touch(value);
+    }
+    asm volatile("" : : "r"(sum));
+}
+
+// 一个连接上依次到达的数据：每次 Append 一段后解析出所有完整的请求，出错即停止
+void parseStream(std::string_view data, size_t step) {
+    HttpRequest request;
+    size_t streamed = 0;
+    request.SetBodyHandler([&streamed](std::string_view chunk) {
+        assert(chunk.size() <= HttpRequest::BODY_CHUNK);
+        streamed += chunk.size();
+    });
+    Buffer buff(64);
+    for (size_t pos = 0; pos < data.size(); pos += step) {
+        buff.Append(data.data() + pos, std::min(step, data.size() - pos));
+        while (buff.ReadableBytes() > 0) {
+            HttpRequest::ParseResult ret = request.Parse(buff);
+            if (ret == HttpRequest::ParseResult::Complete) {
+                checkComplete(request);
+                continue;
+            }
+            if (ret != HttpRequest::ParseResult::Incomplete) {
+                return;
+            }
+            break;
+        }
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static bool init = [] {
+        Log::Instance().SetLevel(LogLevel::OFF);
+        HttpRequest::MaxBody = 64 * 1024;
+        return true;
+    }();
+    (void)init;
+    std::string_view input(reinterpret_cast<const char *>(data), size);
+
+    // 整段到达一次，再按由长度决定的 1-32 字节分段到达一次（录制的请求可以直接作为种子）
+    parseStream(input, size + 1);
+    parseStream(input, size % 32 + 1);
+
+    // 把整个输入当作表单消息体
+    HttpRequest request;
+    request.body = input;
+    request.parseFromUrlencoded();
+    size_t decoded = 0, sum = 0;
+    for (const auto &[key, value] : request.post) {
+        decoded += key.size() + value.size();
+        sum += touch(key) + touch(value);
+    }
+    assert(decoded <= input.size());
+    asm volatile("" : : "r"(sum));
+    return 0;
+}
+
+#ifdef FUZZ_REPLAY
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream in(argv[i], std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+        std::cout << argv[i] << " OK\n";
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,104 @@
+// 文件缓存测试：在临时目录中建文件，检查命中、内存中的小文件和 inotify 失效
+// g++ -std=c++20 testFileCache.cpp -o testFileCache -lmysqlcppconn
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include "FileCache.hpp"
+
+using namespace bre;
+using std::cout;
+using std::string;
+
+void writeFile(const string &path, const string &content) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << content;
+}
+
+// inotify 事件由后台线程异步处理，最多等待 2 秒
+template <typename Pred>
+bool waitFor(Pred pred) {
+    for (int i = 0; i < 200; ++i) {
+        if (pred()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+int main() {
+    Log::Instance().SetLevel(LogLevel::OFF);
+    char tmpl[] = "/tmp/fileCacheXXXXXX";
+    string dir = mkdtemp(tmpl);
+    mkdir((dir + "/sub").data(), 0755);
+    writeFile(dir + "/small.html", "<p>hello</p>");
+    writeFile(dir + "/big.jpg", string(100000, 'x'));
+    writeFile(dir + "/sub/a.css", "a{}");
+    writeFile(dir + "/secret.txt", "no");
+    chmod((dir + "/secret.txt").data(), 0600);
+
+    FileCache cache(16, 1024);
+    // 小文件在内存中，大文件保持打开
+    auto small = cache.Get(dir, "/small.html");
+    assert(small && small->inMemory && small->data == "<p>hello</p>" && small->fd < 0);
+    assert(small->type == "text/html");
+    auto big = cache.Get(dir, "/big.jpg");
+    assert(big && !big->inMemory && big->fd >= 0 && big->Size() == 100000 && big->type == "image/jpeg");
+    assert(cache.Get(dir, "/small.html") == small && cache.Get(dir, "/big.jpg") == big);
+    assert(cache.Get(dir, "/sub/a.css")->data == "a{}");
+    // 目录、无读权限、不存在
+    assert(cache.Get(dir, "/sub")->IsDir());
+    assert(!cache.Get(dir, "/secret.txt")->Readable() && cache.Get(dir, "/secret.txt")->fd < 0);
+    assert(!cache.Get(dir, "/missing.html"));
+    assert(cache.Size() == 5);
+    // 同一文件的不同写法共用一个条目，越出目录的路径不打开
+    assert(cache.Get(dir, "//small.html") == small && cache.Get(dir, "/./sub/../small.html") == small);
+    assert(cache.Contains(dir, "/sub//a.css") && cache.Size() == 5);
+    assert(!cache.Get(dir + "/sub", "/../small.html") && cache.Contains(dir, "/../x"));
+    cout << "Cache hit OK\n";
+
+    // 修改后失效，重新加载到新内容；旧条目仍被引用，内容和 fd 不变
+    writeFile(dir + "/small.html", "<p>changed</p>");
+    assert(waitFor([&] { return cache.Get(dir, "/./small.html") != small; }));
+    assert(cache.Get(dir, "/small.html")->data == "<p>changed</p>" && small->data == "<p>hello</p>");
+    writeFile(dir + "/big.jpg", string(200000, 'y'));
+    assert(waitFor([&] { return cache.Get(dir, "/big.jpg")->Size() == 200000; }));
+    char c = 0;
+    assert(pread(big->fd, &c, 1, 0) == 1 && c == 'y');
+    // 子目录中的文件、权限变化和删除
+    writeFile(dir + "/sub/a.css", "b{}");
+    assert(waitFor([&] { return cache.Get(dir, "/sub/a.css")->data == "b{}"; }));
+    chmod((dir + "/secret.txt").data(), 0644);
+    assert(waitFor([&] { return cache.Get(dir, "/secret.txt")->Readable(); }));
+    unlink((dir + "/sub/a.css").data());
+    assert(waitFor([&] { return !cache.Get(dir, "/sub/a.css"); }));
+    cout << "Invalidation OK\n";
+
+    // 超过条目上限时淘汰旧条目，新文件仍然缓存
+    for (int i = 0; i < 20; ++i) {
+        writeFile(dir + "/f" + std::to_string(i), "x");
+        assert(cache.Get(dir, "/f" + std::to_string(i)));
+    }
+    assert(cache.Size() == 16 && cache.Contains(dir, "/f19"));
+    // 内存总量和打开的 fd 数也有上限，被淘汰的条目仍可使用
+    FileCache limited(16, 1024, 2048, 2);
+    for (int i = 0; i < 4; ++i) {
+        writeFile(dir + "/m" + std::to_string(i), string(1000, 'm'));
+        writeFile(dir + "/b" + std::to_string(i), string(2000, 'b'));
+    }
+    auto first = limited.Get(dir, "/b0");
+    for (int i = 0; i < 4; ++i) {
+        assert(limited.Get(dir, "/m" + std::to_string(i)) && limited.Get(dir, "/b" + std::to_string(i)));
+    }
+    assert(limited.Size() == 4 && limited.Contains(dir, "/m3") && limited.Contains(dir, "/b3"));
+    assert(pread(first->fd, &c, 1, 0) == 1 && c == 'b');
+    cout << "Capacity OK\n";
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,240 @@
+// 流水线请求测试：socketpair 一端作为连接，另一端模拟客户端
+// g++ -std=c++20 testHttpConn.cpp -o testHttpConn -lmysqlcppconn
+#include <iostream>
+#include <cassert>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include "HttpConn.hpp"
+
+using namespace bre;
+using std::cout;
+using std::string;
+
+// 读出对端收到的全部数据
+string drain(int fd) {
+    string out;
+    char buf[65536];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        out.append(buf, n);
+    }
+    return out;
+}
+
+size_t countOf(const string &s, const string &sub) {
+    size_t cnt = 0;
+    for (size_t pos = s.find(sub); pos != string::npos; pos = s.find(sub, pos + 1)) {
+        ++cnt;
+    }
+    return cnt;
+}
+
+// 三个请求一次到达：一批处理，一次 writev 按顺序发出
+void testPipeline() {
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    HttpConn conn;
+    conn.Init(sv[0], {});
+
+    string req = "GET /index.html HTTP/1.1\r\nConnection: keep-alive\r\n\r\n"
+                 "GET /nope HTTP/1.1\r\nConnection: keep-alive\r\n\r\n"
+                 "GET /index.html HTTP/1.1\r\nConnection: keep-alive\r\n\r\n"
+                 "GET /index";
+    assert(send(sv[1], req.data(), req.size(), 0) == static_cast<ssize_t>(req.size()));
+    int err = 0;
+    conn.Read(&err);
+    assert(conn.Process());
+    assert(conn.IsKeepAlive());
+    size_t total = conn.ToWriteBytes();
+    assert(conn.Write(&err) == static_cast<ssize_t>(total) && conn.ToWriteBytes() == 0);
+
+    string out = drain(sv[1]);
+    assert(out.size() == total);
+    assert(countOf(out, "HTTP/1.1 ") == 3);
+    size_t first = out.find("HTTP/1.1 200");
+    size_t second = out.find("HTTP/1.1 404");
+    size_t third = out.find("HTTP/1.1 200", first + 1);
+    assert(first == 0 && first < second && second < third && third != string::npos);
+    // 404 带错误页面
+    assert(out.find("</html>", second) < third);
+
+    // 剩下半个请求，补全后再处理；随后的 Connection: close 请求结束本批
+    string rest = ".html HTTP/1.1\r\nConnection: keep-alive\r\n\r\n"
+                  "GET / HTTP/1.1\r\nConnection: close\r\n\r\n"
+                  "GET /index.html HTTP/1.1\r\n\r\n";
+    assert(!conn.Process());
+    send(sv[1], rest.data(), rest.size(), 0);
+    conn.Read(&err);
+    assert(conn.Process());
+    assert(!conn.IsKeepAlive());
+    conn.Write(&err);
+    out = drain(sv[1]);
+    assert(countOf(out, "HTTP/1.1 200") == 2);
+    assert(conn.ReadBuffer().ReadableBytes() > 0);
+
+    conn.Close();
+    close(sv[1]);
+    cout << "Pipeline OK\n";
+}
+
+// 错误请求：之前的响应照常发出，随后是 400，之后的数据丢弃
+void testPipelineError() {
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    HttpConn conn;
+    conn.Init(sv[0], {});
+    string req = "GET /index.html HTTP/1.1\r\nConnection: keep-alive\r\n\r\n"
+                 "BAD\r\n\r\n"
+                 "GET /index.html HTTP/1.1\r\n\r\n";
+    send(sv[1], req.data(), req.size(), 0);
+    int err = 0;
+    conn.Read(&err);
+    assert(conn.Process());
+    assert(!conn.IsKeepAlive());
+    conn.Write(&err);
+    string out = drain(sv[1]);
+    assert(out.find("HTTP/1.1 200") == 0);
+    assert(countOf(out, "HTTP/1.1 ") == 2 && out.find("HTTP/1.1 400") != string::npos);
+    assert(conn.ReadBuffer().ReadableBytes() == 0);
+    conn.Close();
+    close(sv[1]);
+    cout << "Pipeline error OK\n";
+}
+
+string readFile(const string &path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// 两个大文件之间夹一个无文件的响应：非阻塞套接字上分多次 sendfile，文件内容与头部按顺序完整到达
+void testFileBody() {
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL) | O_NONBLOCK);
+    HttpConn conn;
+    conn.Init(sv[0], {});
+    string req = "GET /images/2.jpg HTTP/1.1\r\nConnection: keep-alive\r\n\r\n"
+                 "GET /nope HTTP/1.1\r\nConnection: keep-alive\r\n\r\n"
+                 "GET /images/5.jpg HTTP/1.1\r\nConnection: keep-alive\r\n\r\n";
+    send(sv[1], req.data(), req.size(), 0);
+    int err = 0;
+    conn.Read(&err);
+    assert(conn.Process());
+    size_t total = conn.ToWriteBytes();
+    string out;
+    int writes = 0;
+    while (conn.ToWriteBytes() > 0) {
+        ssize_t len = conn.Write(&err);
+        assert(len > 0 || err == EAGAIN);
+        ++writes;
+        out += drain(sv[1]);
+    }
+    out += drain(sv[1]);
+    assert(writes > 1 && out.size() == total);
+
+    string first = readFile(string(HttpConn::SrcDir) + "/images/2.jpg");
+    string second = readFile(string(HttpConn::SrcDir) + "/images/5.jpg");
+    size_t body1 = out.find("\r\n\r\n") + 4;
+    assert(out.compare(body1, first.size(), first) == 0);
+    size_t notFound = out.find("HTTP/1.1 404", body1 + first.size());
+    size_t third = out.find("HTTP/1.1 200", body1 + first.size());
+    assert(notFound == body1 + first.size() && third != string::npos && notFound < third);
+    size_t body2 = out.find("\r\n\r\n", third) + 4;
+    assert(out.size() == body2 + second.size() && out.compare(body2, second.size(), second) == 0);
+
+    conn.Close();
+    close(sv[1]);
+    cout << "File body OK (" << writes << " writes)\n";
+}
+
+// 大文件的范围请求：单个区间和多个区间都从文件中间 sendfile，与流水线中的其他响应按顺序到达
+void testRange() {
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    fcntl(sv[0], F_SETFL, fcntl(sv[0], F_GETFL) | O_NONBLOCK);
+    HttpConn conn;
+    conn.Init(sv[0], {});
+    string req = "GET /images/3.jpg HTTP/1.1\r\nConnection: keep-alive\r\nRange: bytes=1000000-1299999\r\n\r\n"
+                 "GET /images/3.jpg HTTP/1.1\r\nConnection: keep-alive\r\nRange: bytes=0-99, 2000000-2099999\r\n\r\n"
+                 "GET /index.html HTTP/1.1\r\nConnection: keep-alive\r\nRange: bytes=-10\r\n\r\n";
+    send(sv[1], req.data(), req.size(), 0);
+    int err = 0;
+    conn.Read(&err);
+    assert(conn.Process());
+    size_t total = conn.ToWriteBytes();
+    string out;
+    while (conn.ToWriteBytes() > 0) {
+        assert(conn.Write(&err) > 0 || err == EAGAIN);
+        out += drain(sv[1]);
+    }
+    out += drain(sv[1]);
+    assert(out.size() == total && countOf(out, "HTTP/1.1 206 Partial Content") == 3);
+
+    string image = readFile(string(HttpConn::SrcDir) + "/images/3.jpg");
+    string index = readFile(string(HttpConn::SrcDir) + "/index.html");
+    size_t body = out.find("\r\n\r\n") + 4;
+    assert(out.compare(body, 300000, image, 1000000, 300000) == 0);
+    size_t part1 = out.find("Content-Range: bytes 0-99/", body + 300000);
+    size_t part2 = out.find("Content-Range: bytes 2000000-2099999/", part1);
+    assert(part1 != string::npos && part2 != string::npos);
+    body = out.find("\r\n\r\n", part1) + 4;
+    assert(out.compare(body, 100, image, 0, 100) == 0);
+    body = out.find("\r\n\r\n", part2) + 4;
+    assert(out.compare(body, 100000, image, 2000000, 100000) == 0);
+    assert(out.compare(out.size() - 10, 10, index, index.size() - 10, 10) == 0);
+
+    conn.Close();
+    close(sv[1]);
+    cout << "Range OK\n";
+}
+
+// 运行到完成模式：未缓存的文件和登录请求留给线程池，之前的响应照常发出
+void testDefer() {
+    int sv[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    HttpConn conn;
+    conn.Init(sv[0], {});
+    string req = "GET /index.html HTTP/1.1\r\nConnection: keep-alive\r\n\r\n"
+                 "GET /405.html HTTP/1.1\r\nConnection: keep-alive\r\n\r\n";
+    send(sv[1], req.data(), req.size(), 0);
+    int err = 0;
+    conn.Read(&err);
+    // index.html 之前已缓存，405.html 还没有，停在它之前
+    assert(conn.Process(false) && conn.MayBlock());
+    conn.Write(&err);
+    assert(countOf(drain(sv[1]), "HTTP/1.1 ") == 1);
+    assert(conn.Process() && !conn.MayBlock());
+    conn.Write(&err);
+    string out = drain(sv[1]);
+    assert(out.find("HTTP/1.1 200") == 0 && out.find("</html>") != string::npos);
+
+    // 消息体分两次到达：第二次读到的数据不以 "POST " 开头，仍然要留给线程池
+    string head = "POST /login HTTP/1.1\r\nConnection: keep-alive\r\n"
+                  "Content-Type: application/x-www-form-urlencoded\r\nContent-Length: 40000\r\n\r\n";
+    string body(40000, 'a');
+    send(sv[1], head.data(), head.size(), 0);
+    send(sv[1], body.data(), 20000, 0);
+    conn.Read(&err);
+    assert(!conn.Process(false) && !conn.MayBlock());
+    send(sv[1], body.data() + 20000, 20000, 0);
+    conn.Read(&err);
+    assert(!conn.Process(false) && conn.MayBlock());
+    conn.Close();
+    close(sv[1]);
+    cout << "Defer OK\n";
+}
+
+int main() {
+    HttpConn::SrcDir = "../resources";
+    testPipeline();
+    testPipelineError();
+    testFileBody();
+    testRange();
+    testDefer();
+    return 0;
+}
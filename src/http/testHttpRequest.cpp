@@ -1,4 +1,5 @@
 #include "HttpRequest.hpp"
+#include <cassert>
 
 using namespace bre;
 using namespace std;
@@ -7,7 +8,7 @@ using namespace std;
 void testFuncPrase() {
     Buffer buffer;
     HttpRequest request;
-    string str = "GET / HTTP/1.1\r\n"
+    string str = "POST /login HTTP/1.1\r\n"
                     "Host: www.baidu.com\r\n"
                     "Connection: keep-alive\r\n"
                     "Cache-Control: max-age=0\r\n"
@@ -16,20 +17,264 @@ void testFuncPrase() {
                     "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,image/apng,*/*;q=0.8\r\n"
                     "Accept-Encoding: gzip, deflate, br\r\n"
                     "Accept-Language: zh-CN,zh;q=0.9\r\n"
-                    "Content-Type: application/x-www-form-urlencoded\r\n"
+                    "Content-Type: text/plain\r\n"
                     "Content-Length: 23\r\n"
-                    "key1=value1&key2=value2\r\n"
-                    "\r\n";
+                    "\r\n"
+                    "key1=value1&key2=value2";
     buffer.Append(str);
-    request.Parse(buffer);
+    assert(request.Parse(buffer) == HttpRequest::ParseResult::Complete);
+    assert(buffer.ReadableBytes() == 0);
 
-    cout << "header size: " << request.header.size() << "\n";
-    for(auto it = request.header.begin(); it != request.header.end(); it++) {
-        cout << it->first << " : " << it->second << "\n";
-    }
+    cout << "header size: " << request.HeaderCount() << "\n";
+    request.ForEachHeader([](string_view key, string_view value) {
+        cout << key << " : " << value << "\n";
+    });
+    assert(request.Method() == "POST");
+    assert(request.Path() == "/login");
+    assert(request.GetHeader("content-length") == "23");
+    assert(request.GetHeader(HeaderId::ContentLength) == "23");
+    assert(request.GetHeader("upgrade-insecure-requests") == "1");
+    assert(request.HeaderCount() == 10 && request.OtherHeaders().size() == 1);
+    assert(request.Body() == "key1=value1&key2=value2");
+    assert(request.IsKeepAlive());
     cout << "\n\n";
 }
 
+// 数据不完整时不消耗缓冲区，补齐后再解析
+void testIncomplete() {
+    Buffer buffer;
+    HttpRequest request;
+    string str = "GET /index.html?a=1&b=2 HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n";
+    for (size_t i = 0; i < str.size(); ++i) {
+        buffer.Append(str.data() + i, 1);
+        auto ret = request.Parse(buffer);
+        assert(ret == (i + 1 == str.size() ? HttpRequest::ParseResult::Complete
+                                            : HttpRequest::ParseResult::Incomplete));
+    }
+    assert(request.Path() == "/index.html");
+    assert(request.Query() == "a=1&b=2");
+    assert(!request.IsKeepAlive());
+    cout << "Incomplete parse OK\n";
+}
+
+// 分段到达且缓冲区在两次解析之间扩容：已解析的部分跟着移动，消息体跨段也能取完
+void testResume() {
+    Buffer buffer(1);
+    HttpRequest request;
+    string str = "POST /echo HTTP/1.1\r\nHost: x\r\nConnection: keep-alive\r\nContent-Length: 11\r\n\r\nhello world"
+                 "GET /next HTTP/1.1\r\n\r\n";
+    size_t cuts[] = {3, 17, 18, 30, 64, 70, 83, str.size()};
+    size_t pos = 0;
+    int complete = 0;
+    for (size_t cut : cuts) {
+        buffer.Append(str.data() + pos, cut - pos);
+        pos = cut;
+        while (buffer.ReadableBytes() > 0 && request.Parse(buffer) == HttpRequest::ParseResult::Complete) {
+            if (++complete == 1) {
+                assert(request.Method() == "POST" && request.Path() == "/echo");
+                assert(request.GetHeader("host") == "x");
+                assert(request.Body() == "hello world");
+                assert(request.IsKeepAlive());
+            }
+        }
+    }
+    assert(complete == 2);
+    assert(request.Method() == "GET" && request.Path() == "/next");
+    assert(request.HeaderCount() == 0 && buffer.ReadableBytes() == 0);
+    cout << "Resume parse OK\n";
+}
+
+// chunked 逐字节到达：块数据按顺序交给 BodyHandler，表单收集为完整消息体
+void testChunked() {
+    Buffer buffer;
+    HttpRequest request;
+    string received;
+    request.SetBodyHandler([&](string_view data) { received.append(data); });
+    string str = "POST /echo HTTP/1.1\r\nTransfer-Encoding: chunked\r\n"
+                 "Content-Type: application/x-www-form-urlencoded\r\n\r\n"
+                 "5\r\nkey1=\r\nB;ext=1\r\nvalue1&key2\r\n7\r\n=value2\r\n0\r\nTrailer: x\r\n\r\n"
+                 "GET /next HTTP/1.1\r\n\r\n";
+    size_t complete = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        buffer.Append(str.data() + i, 1);
+        if (request.Parse(buffer) == HttpRequest::ParseResult::Complete && ++complete == 1) {
+            assert(request.Path() == "/echo");
+            assert(request.GetHeader("Transfer-Encoding") == "chunked");
+            assert(request.Body() == "key1=value1&key2=value2");
+            assert(request.GetPost("key2") == "value2");
+            assert(received == "key1=value1&key2=value2");
+        }
+        // 流式接收时已交付的数据不留在缓冲区中（最多留下未完整的块大小行）
+        if (i >= str.find("\r\n\r\n") + 4 && i < str.find("GET /next")) {
+            assert(buffer.ReadableBytes() < 16);
+        }
+    }
+    assert(complete == 2 && request.Path() == "/next");
+    cout << "Chunked body OK\n";
+}
+
+// 大消息体分段到达：按块交付，缓冲区不随消息体增长；超过 MaxBody 返回 TooLarge
+void testLargeBody() {
+    const size_t size = 1000000;
+    Buffer buffer;
+    HttpRequest request;
+    size_t received = 0, maxChunk = 0;
+    request.SetBodyHandler([&](string_view data) {
+        received += data.size();
+        maxChunk = max(maxChunk, data.size());
+    });
+    string head = "PUT /upload HTTP/1.1\r\nContent-Length: " + to_string(size) + "\r\n\r\n";
+    buffer.Append(head);
+    assert(request.Parse(buffer) == HttpRequest::ParseResult::Incomplete);
+    string piece(40000, 'x');
+    size_t sent = 0;
+    HttpRequest::ParseResult ret = HttpRequest::ParseResult::Incomplete;
+    while (sent < size) {
+        size_t len = min(piece.size(), size - sent);
+        buffer.Append(piece.data(), len);
+        sent += len;
+        ret = request.Parse(buffer);
+        assert(buffer.ReadableBytes() == 0);
+    }
+    assert(ret == HttpRequest::ParseResult::Complete);
+    assert(received == size && maxChunk <= HttpRequest::BODY_CHUNK);
+    assert(request.Method() == "PUT" && request.Path() == "/upload" && request.Body().empty());
+
+    size_t saved = HttpRequest::MaxBody;
+    HttpRequest::MaxBody = 100;
+    const char *tooLarge[] = {
+        "POST / HTTP/1.1\r\nContent-Length: 101\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n50\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1\r\nx\r\n64\r\n",
+    };
+    for (const char *str : tooLarge) {
+        Buffer buff;
+        HttpRequest req;
+        buff.Append(string(str));
+        if (string(str).find("50\r\n") != string::npos) {
+            buff.Append(string(80, 'x') + "\r\n64\r\n");
+        }
+        assert(req.Parse(buff) == HttpRequest::ParseResult::TooLarge);
+    }
+    HttpRequest::MaxBody = saved;
+    cout << "Large body OK\n";
+}
+
+// 常用头部的完美哈希：每个名字（任意大小写）都能找到自己的槽位，相近的名字找不到
+void testKnownHeaders() {
+    for (size_t i = 0; i < KnownHeaders::COUNT; ++i) {
+        string name(KnownHeaders::NAMES[i]);
+        assert(KnownHeaders::Lookup(name) == static_cast<HeaderId>(i));
+        for (auto &c : name) {
+            c = static_cast<char>(toupper(c));
+        }
+        assert(KnownHeaders::Lookup(name) == static_cast<HeaderId>(i));
+        name.pop_back();
+        assert(KnownHeaders::Lookup(name) == HeaderId::Unknown);
+    }
+    assert(KnownHeaders::Lookup("X-Forwarded-For") == HeaderId::Unknown);
+    assert(KnownHeaders::Lookup("") == HeaderId::Unknown);
+
+    Buffer buffer;
+    HttpRequest request;
+    buffer.Append("GET / HTTP/1.1\r\nACCEPT: a\r\nX-Custom: 1\r\nAccept: b\r\nRange:\r\n\r\n");
+    assert(request.Parse(buffer) == HttpRequest::ParseResult::Complete);
+    assert(request.GetHeader(HeaderId::Accept) == "a" && request.GetHeader("accept") == "a");
+    assert(request.GetHeader("x-custom") == "1");
+    assert(request.GetHeader(HeaderId::Range).empty() && request.GetHeader(HeaderId::Range).data() != nullptr);
+    assert(request.GetHeader(HeaderId::IfRange).data() == nullptr);
+    assert(request.OtherHeaders().size() == 2 && request.HeaderCount() == 4);
+    cout << "Known headers OK\n";
+}
+
+// 同一个对象连续解析：超出 arena 初始块的表单落到上游分配，下一个请求开始时整体释放，不残留上一个请求的数据
+void testArena() {
+    string form;
+    for (int i = 0; i < 500; ++i) {
+        form += (i ? "&key" : "key") + to_string(i) + "=value%20" + to_string(i);
+    }
+    Buffer buffer;
+    HttpRequest request;
+    for (int round = 0; round < 3; ++round) {
+        buffer.Append("POST /submit HTTP/1.1\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                      "Content-Length: " + to_string(form.size()) + "\r\n\r\n" + form);
+        assert(request.Parse(buffer) == HttpRequest::ParseResult::Complete);
+        assert(request.GetPost("key0") == "value 0" && request.GetPost("key499") == "value 499");
+
+        buffer.Append("POST /submit HTTP/1.1\r\nContent-Type: application/x-www-form-urlencoded\r\n"
+                      "Content-Length: 5\r\nX-A: 1\r\n\r\na=b+c");
+        assert(request.Parse(buffer) == HttpRequest::ParseResult::Complete);
+        assert(request.GetPost("a") == "bc" && request.GetPost("key0").empty());
+        assert(request.OtherHeaders().size() == 1);
+    }
+    cout << "Arena reuse OK\n";
+}
+
+// 表单与查询参数在第一次读取时才解析；不需要解码的值直接指向消息体
+void testUrlDecode() {
+    Buffer buffer;
+    HttpRequest request;
+    string body = "user=some+user&pwd=p%40ss%2Bw&plain=abc&empty=&k=%20%20v%20&bad=%zz%4&k=last&noeq&%41%42=ab";
+    buffer.Append("POST /submit?q=a+b%21&x=%ZZ&x=2 HTTP/1.1\r\n"
+                  "Content-Type: application/x-www-form-urlencoded\r\n"
+                  "Content-Length: " + to_string(body.size()) + "\r\n\r\n" + body);
+    assert(request.Parse(buffer) == HttpRequest::ParseResult::Complete);
+    assert(request.post.empty() && request.queryFields.empty());
+
+    assert(request.GetPost("user") == "someuser");
+    assert(request.post.size() == 8);
+    assert(request.GetPost("pwd") == "p@ssw");
+    assert(request.GetPost("plain") == "abc");
+    assert(request.GetPost("plain").data() >= request.Body().data() &&
+           request.GetPost("plain").data() < request.Body().data() + request.Body().size());
+    assert(request.GetPost("empty").empty() && request.GetPost("empty").data() != nullptr);
+    assert(request.GetPost("missing").data() == nullptr && request.GetPost("noeq").data() == nullptr);
+    assert(request.GetPost("k") == "last");
+    assert(request.GetPost("bad") == "%zz%4");
+    assert(request.GetPost("AB") == "ab");
+    assert(request.Body() == body);
+
+    assert(request.GetQuery("q") == "a b!");
+    assert(request.GetQuery("x") == "2");
+    assert(request.GetQuery("y").data() == nullptr);
+
+    // 不是表单的 POST 不解析
+    buffer.Append("POST /submit HTTP/1.1\r\nContent-Type: text/plain\r\nContent-Length: 3\r\n\r\na=b");
+    assert(request.Parse(buffer) == HttpRequest::ParseResult::Complete);
+    assert(request.GetPost("a").data() == nullptr && request.GetQuery("q").data() == nullptr);
+    cout << "URL decode OK\n";
+}
+
+void testBadRequest() {
+    const char *bad[] = {
+        "BAD\r\n\r\n",
+        "GET  / HTTP/1.1\r\n\r\n",
+        "GET / FTP/1.1\r\n\r\n",
+        "G(T / HTTP/1.1\r\n\r\n",
+        "GET / HTTP/1.1\r\nNoColon\r\n\r\n",
+        "GET / HTTP/1.1\r\n folded: x\r\n\r\n",
+        "GET / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n",
+        "GET / HTTP/1.1\rHost: x\r\n\r\n",
+        "GET /\x01 HTTP/1.1\r\n\r\n",
+        "GET / HTTP/1.1\r\nHost: a\x7f\r\n\r\n",
+        "GET / HTTP/1.1\r\n: empty\r\n\r\n",
+        "GET / HTTP/1.1\r\nHo st: x\r\n\r\n",
+        "GET / HTTP/1.1\r\nHost: a\r\nhost: b\r\n\r\n",
+        "POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 1\r\n\r\nx",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 3\r\n\r\n0\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: gzip\r\n\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n",
+        "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nabc\r\n0\r\n\r\n",
+    };
+    for (const char *str : bad) {
+        Buffer buffer;
+        HttpRequest request;
+        buffer.Append(string(str));
+        assert(request.Parse(buffer) == HttpRequest::ParseResult::Error);
+    }
+    cout << "Bad requests rejected\n";
+}
+
 void testParseFromUrlencoded() {
 HttpRequest request;
 
@@ -56,7 +301,7 @@ for (const auto& [input, expectedOutput] : testData) {
     // 验证结果
     bool isCorrect = true;
     for (const auto& [expectedKey, expectedValue] : expectedOutput) {
-        if (request.post.count(expectedKey) == 0 || request.post[expectedKey] != expectedValue) {
+        if (request.GetPost(expectedKey).data() == nullptr || request.GetPost(expectedKey) != expectedValue) {
             isCorrect = false;
             break;
         }
@@ -82,7 +327,9 @@ cout << request.userVerify("test", "666666", true) << "\n";
 
 void testParseRequestLine() {
     HttpRequest request;
-    std::cout << request.parseRequestLine("GET / HTTP/1.1") << "\n";
+    const char line[] = "GET / HTTP/1.1\r\n";
+    const char *p = line;
+    std::cout << (request.parseRequestLine(p, line + sizeof(line) - 1) == HttpRequest::ParseResult::Complete) << "\n";
     std::cout << request.method << "\n";
     std::cout << request.path << "\n";
     std::cout << request.version << "\n";
@@ -92,49 +339,77 @@ void testParseRequestLine() {
 void testParseHeader() {
     std::cout << "Test parseHeader" << std::endl;
     HttpRequest request;
-    request.parseHeader("Host: www.baidu.com");
-    cout << request.header.size() << "\n";
-    cout << request.header["Host"] << "\n";
-}
-
-void testParseBody() {
-    HttpRequest request;
-    request.parseBody("key1=value1&key2=value2");
-    cout << request.body << "\n";
-
-}
-
-void testParsePath() {
-    HttpRequest request;
-    request.path = "/";
-    request.parsePath();
-    cout << request.path << "\n";
-
-    request.path = "/login";
-    request.parsePath();
-    cout << request.path << "\n";
+    const char line[] = "Host: www.baidu.com\r\n";
+    const char *p = line;
+    request.parseHeader(p, line + sizeof(line) - 1);
+    cout << request.HeaderCount() << "\n";
+    cout << request.GetHeader("Host") << "\n";
 }
 
 void testParsePost() {
     bre::HttpRequest request;
     request.method = "POST";
-    request.header["Content-Type"] = "application/x-www-form-urlencoded";
+    request.addHeader("Content-Type", "application/x-www-form-urlencoded");
     request.body = "username=user&password=pass&key1=value1&key2=value2";
     request.parsePost();
     std::cout << request.post.size() << "\n";
-    std::cout << request.post["key1"] << "\n";
-    std::cout << request.post["key2"] << "\n";
+    std::cout << request.GetPost("key1") << "\n";
+    std::cout << request.GetPost("key2") << "\n";
 }
 
 
+// 头部解析完时按请求选择 BodyHandler（HttpConn 按路由选择）：只对有消息体的请求调用
+void testHeadersHandler() {
+    using Result = HttpRequest::ParseResult;
+    Buffer buffer;
+    HttpRequest request;
+    size_t calls = 0, received = 0;
+    request.SetHeadersHandler([&](HttpRequest &req) {
+        ++calls;
+        if (req.Path() == "/upload") {
+            req.SetBodyHandler([&](string_view data) { received += data.size(); });
+        } else {
+            req.SetBodyHandler(nullptr);
+        }
+    });
+    string head = "GET /a HTTP/1.1\r\n\r\n"
+                  "PUT /upload HTTP/1.1\r\nContent-Length: 50000\r\n\r\n";
+    buffer.Append(head);
+    assert(request.Parse(buffer) == Result::Complete && calls == 0);
+    assert(request.Parse(buffer) == Result::Incomplete && calls == 1);
+    string piece(25000, 'x');
+    buffer.Append(piece);
+    assert(request.Parse(buffer) == Result::Incomplete);
+    buffer.Append(piece);
+    assert(request.Parse(buffer) == Result::Complete);
+    assert(received == 50000 && request.Body().empty());
+
+    // 没有选择 BodyHandler 的请求照常收集
+    head = "POST /echo HTTP/1.1\r\nContent-Length: 50000\r\n\r\n";
+    buffer.Append(head);
+    buffer.Append(piece);
+    assert(request.Parse(buffer) == Result::Incomplete && calls == 2);
+    buffer.Append(piece);
+    assert(request.Parse(buffer) == Result::Complete);
+    assert(received == 50000 && request.Body().size() == 50000);
+    cout << "Headers handler OK\n";
+}
+
 int main() {
     testFuncPrase();
+    testIncomplete();
+    testResume();
+    testChunked();
+    testLargeBody();
+    testHeadersHandler();
+    testKnownHeaders();
+    testArena();
+    testUrlDecode();
+    testBadRequest();
     // testParseFromUrlencoded();
     // testuserVerify();
     // testParseRequestLine();
     // testParseHeader();
-    // testParseBody();
-    // testParsePath();
     // testParsePost();
 
 
@@ -1,10 +1,10 @@
 #include "HttpResponse.hpp"
 #include "../buffer/Buffer.hpp"
 #include "../mylog/Log.hpp"
-#include <sys/mman.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <iostream>
+#include <fstream>
 #include <cassert>
 
 using namespace bre;
@@ -20,17 +20,25 @@ void test_init_and_destruct()
         resp.Init(".", path);
         assert(resp.path == "/index.html");
         assert(resp.srcDir == ".");
-        assert(!resp.mmFile); // 没有调用MakeResponse前，mmFile应为nullptr
+        assert(resp.FileLen() == 0); // 没有调用MakeResponse前不取文件
     }
     catch (...)
     {
         assert(false);
     }
     resp.MakeResponse(buff);
-    assert(resp.mmFile);
+    assert(resp.FileLen() > 0 && (resp.FileData() || resp.FileFd() >= 0));
 
+    // 缓存文件的头部预先生成，buff 中只有 Date 和空行，不附带文件内容
+    string block(resp.HeaderBlock());
     string content = buff.RetrieveAll();
-    cout << content << endl;
+    cout << block << content << endl;
+    assert(block.find("HTTP/1.1 200 OK\r\n") == 0 && block.find("Content-type: text/html\r\n") != string::npos);
+    assert(block.find("Content-length: " + to_string(resp.FileLen()) + "\r\n") != string::npos);
+    assert(content.find("Date: ") == 0 && content.size() == 6 + 29 + 4);
+    assert(content.compare(content.size() - 4, 4, "\r\n\r\n") == 0);
+    resp.ReleaseFile();
+    assert(resp.FileLen() == 0 && resp.HeaderBlock().empty());
 
     std::cout << "Test init and destruct success!" << std::endl;
 }
@@ -97,6 +105,128 @@ void test_error_content()
     std::cout << "Test error content success!" << std::endl;
 }
 
+// 取预先生成的头部中某个字段的值
+string headerValue(string_view block, const string &name)
+{
+    size_t pos = block.find(name + ": ");
+    assert(pos != string::npos);
+    pos += name.size() + 2;
+    return string(block.substr(pos, block.find("\r\n", pos) - pos));
+}
+
+int conditionalCode(string_view ifNoneMatch, string_view ifModifiedSince)
+{
+    Buffer buff;
+    HttpResponse resp;
+    string path = "/index.html";
+    resp.Init(".", path, true, 200);
+    resp.SetConditional(ifNoneMatch, ifModifiedSince);
+    resp.MakeResponse(buff);
+    if (resp.Code() == 304)
+    {
+        // 304 没有消息体，也没有 Content-length
+        assert(resp.FileLen() == 0 && resp.Ranges().empty());
+        assert(resp.HeaderBlock().find("HTTP/1.1 304 Not Modified\r\n") == 0);
+        assert(resp.HeaderBlock().find("Content-length") == string::npos);
+    }
+    return resp.Code();
+}
+
+void test_conditional()
+{
+    Buffer buff;
+    HttpResponse resp;
+    string path = "/index.html";
+    resp.Init(".", path, true, 200);
+    resp.MakeResponse(buff);
+    string etag = headerValue(resp.HeaderBlock(), "ETag");
+    string modified = headerValue(resp.HeaderBlock(), "Last-Modified");
+    cout << etag << " " << modified << endl;
+    assert(etag.size() > 2 && etag.front() == '"' && etag.back() == '"');
+
+    assert(conditionalCode("", "") == 200);
+    assert(conditionalCode(etag, "") == 304);
+    assert(conditionalCode("\"x\", W/" + etag, "") == 304);
+    assert(conditionalCode("*", "") == 304);
+    assert(conditionalCode("\"x\"", modified) == 200); // If-None-Match 优先
+    assert(conditionalCode("", modified) == 304);
+    assert(conditionalCode("", "Sun, 06 Nov 1994 08:49:37 GMT") == 200);
+    assert(conditionalCode("", "yesterday") == 200);
+
+    std::cout << "Test conditional success!" << std::endl;
+}
+
+// 按 Range 生成响应，返回头部和 Ranges 拼出的文件内容
+int rangeCode(string_view range, string_view ifRange, string &head, string &body)
+{
+    Buffer buff;
+    HttpResponse resp;
+    string path = "/index.html";
+    resp.Init(".", path, true, 200);
+    resp.SetRange(range, ifRange);
+    resp.MakeResponse(buff);
+    string out = string(resp.HeaderBlock()) + buff.RetrieveAll();
+    size_t headLen = out.find("\r\n\r\n") + 4;
+    head = out.substr(0, headLen);
+    // 消息体：buff 中的内容与文件片段交替
+    body.clear();
+    size_t pos = headLen - resp.HeaderBlock().size();
+    string rest = out.substr(resp.HeaderBlock().size());
+    for (const auto &r : resp.Ranges())
+    {
+        body += rest.substr(pos, r.buffEnd - pos);
+        body.append(resp.FileData() + r.offset, r.len);
+        pos = r.buffEnd;
+    }
+    body += rest.substr(pos);
+    return resp.Code();
+}
+
+void test_range()
+{
+    std::ifstream in("./index.html", std::ios::binary);
+    string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    string size = to_string(file.size());
+    string head, body;
+
+    assert(rangeCode("bytes=0-9", "", head, body) == 206);
+    assert(head.find("HTTP/1.1 206 Partial Content\r\n") == 0 && body == file.substr(0, 10));
+    assert(head.find("Content-Range: bytes 0-9/" + size + "\r\n") != string::npos);
+    assert(head.find("Content-length: 10\r\n") != string::npos);
+    assert(rangeCode("bytes=100-", "", head, body) == 206 && body == file.substr(100));
+    assert(rangeCode("bytes=-20", "", head, body) == 206 && body == file.substr(file.size() - 20));
+    assert(rangeCode("bytes=10-99999999", "", head, body) == 206 && body == file.substr(10));
+
+    // 多个区间
+    assert(rangeCode("bytes=0-1, 5-7,-3", "", head, body) == 206);
+    assert(head.find("multipart/byteranges; boundary=") != string::npos);
+    string boundary = string("--") + HttpResponse::BOUNDARY;
+    assert(body.find(boundary + "\r\nContent-type: text/html\r\nContent-Range: bytes 0-1/" + size + "\r\n\r\n" + file.substr(0, 2)) != string::npos);
+    assert(body.find("Content-Range: bytes 5-7/" + size + "\r\n\r\n" + file.substr(5, 3) + "\r\n") != string::npos);
+    assert(body.size() >= boundary.size() + 6 && body.compare(body.size() - boundary.size() - 4, boundary.size() + 4, boundary + "--\r\n") == 0);
+    size_t lenPos = head.find("Content-length: ") + 16;
+    assert(stoul(head.substr(lenPos)) == body.size());
+
+    // 不可满足，格式错误时忽略 Range
+    assert(rangeCode("bytes=" + size + "-", "", head, body) == 416 && body.empty());
+    assert(head.find("Content-Range: bytes */" + size + "\r\n") != string::npos);
+    assert(rangeCode("bytes=5-1", "", head, body) == 200 && body == file);
+    assert(rangeCode("items=0-1", "", head, body) == 200);
+    assert(rangeCode("bytes=0-1,,2-3", "", head, body) == 200);
+
+    // If-Range：ETag 或 Last-Modified 一致时才按区间发送
+    rangeCode("", "", head, body);
+    string etag = headerValue(head, "ETag");
+    string modified = headerValue(head, "Last-Modified");
+    assert(head.find("Accept-Ranges: bytes\r\n") != string::npos);
+    assert(rangeCode("bytes=0-0", etag, head, body) == 206 && body == file.substr(0, 1));
+    assert(rangeCode("bytes=0-0", modified, head, body) == 206);
+    assert(rangeCode("bytes=0-0", "\"other\"", head, body) == 200 && body == file);
+    assert(rangeCode("bytes=0-0", "W/" + etag, head, body) == 200);
+
+    std::cout << "Test range success!" << std::endl;
+}
+
 int main()
 {
     test_init_and_destruct();
@@ -104,5 +234,7 @@ int main()
     test_add_header();
     test_get_file_type();
     test_error_content();
+    test_conditional();
+    test_range();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "Router.hpp"
+#include <cassert>
+#include <iostream>
+
+using namespace bre;
+using namespace std;
+
+// 记录命中的路由名，便于断言
+class NameHandler : public HttpHandler {
+public:
+    explicit NameHandler(string name) : name(std::move(name)) {}
+    void Handle(HttpRequest &, const RouteMatch &, HttpResponse &response) const override {
+        response.SetPath(name);
+    }
+    string name;
+};
+
+string route(const Router &router, string_view path, RouteMatch &match) {
+    if (!router.Match(path, match)) {
+        return "";
+    }
+    return static_cast<const NameHandler &>(*match.route->handler).name;
+}
+
+// 静态段优先于参数段，参数段优先于前缀；静态段走不通时回退
+void testPriority() {
+    Router router;
+    router.Add("/users", make_unique<NameHandler>("list"));
+    router.Add("/users/me", make_unique<NameHandler>("me"));
+    router.Add("/users/:id", make_unique<NameHandler>("user"));
+    router.Add("/users/:id/posts/:post", make_unique<NameHandler>("post"));
+    router.Add("/users/me/settings", make_unique<NameHandler>("settings"));
+    router.Add("/static/*", make_unique<NameHandler>("static"));
+    router.Add("/*", make_unique<NameHandler>("fallback"));
+
+    RouteMatch match;
+    assert(route(router, "/users", match) == "list");
+    assert(route(router, "/users/me", match) == "me" && match.paramCount == 0);
+    assert(route(router, "/users/42", match) == "user" && match.Param("id") == "42");
+    assert(route(router, "/users/me/posts/7", match) == "post");
+    assert(match.Param("id") == "me" && match.Param("post") == "7" && match.Param("x").empty());
+    assert(route(router, "/users/me/settings", match) == "settings");
+    assert(route(router, "/static/css/a.css", match) == "static" && match.rest == "css/a.css");
+    assert(route(router, "/static", match) == "fallback" && match.rest == "static");
+    assert(route(router, "/users/42/other", match) == "fallback" && match.paramCount == 0);
+    assert(route(router, "/users/", match) == "fallback");
+    assert(route(router, "/", match) == "fallback");
+    assert(!router.Match("", match) && !router.Match("users", match));
+
+    Router empty;
+    assert(!empty.Match("/", match));
+    cout << "Route priority OK\n";
+}
+
+void testInvalid() {
+    static_assert(Router::ValidPattern("/") && Router::ValidPattern("/a/:b/*"));
+    static_assert(!Router::ValidPattern("") && !Router::ValidPattern("a"));
+    static_assert(!Router::ValidPattern("/a/*/b") && !Router::ValidPattern("/a*") && !Router::ValidPattern("/a/:"));
+    static_assert(!Router::ValidPattern("/:a/:b/:c/:d/:e/:f/:g/:h/:i"));
+
+    Router router;
+    router.Add("/a/:id", make_unique<NameHandler>("a"));
+    for (const char *pattern : {"/a/:other", "a", "/x/*/y"}) {
+        bool thrown = false;
+        try {
+            router.Add(pattern, make_unique<NameHandler>("dup"));
+        } catch (const invalid_argument &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    cout << "Invalid routes rejected OK\n";
+}
+
+// 几百条路由时结果不变
+void testMany() {
+    Router router;
+    for (int i = 0; i < 500; ++i) {
+        router.Add("/api/v" + to_string(i % 5) + "/item" + to_string(i), make_unique<NameHandler>(to_string(i)));
+        router.Add("/api/v" + to_string(i % 5) + "/item" + to_string(i) + "/:id", make_unique<NameHandler>("p" + to_string(i)));
+    }
+    RouteMatch match;
+    for (int i = 0; i < 500; ++i) {
+        string path = "/api/v" + to_string(i % 5) + "/item" + to_string(i);
+        assert(route(router, path, match) == to_string(i));
+        assert(route(router, path + "/x", match) == "p" + to_string(i) && match.Param("id") == "x");
+    }
+    assert(!router.Match("/api/v0/item1", match));
+    assert(router.Routes().size() == 1000);
+    cout << "Many routes OK\n";
+}
+
+// 内置路由与原来 parsePath、登录注册的对应关系
+void testBuiltin() {
+    Router router(Router::BUILTIN_ROUTES);
+    const pair<const char *, const char *> cases[] = {
+        {"/", "/index.html"},
+        {"/index", "/index.html"},
+        {"/login", "/login.html"},
+        {"/register", "/register.html"},
+        {"/picture", "/picture.html"},
+        {"/images/6.jpg", "/images/6.jpg"},
+        {"/index.html", "/index.html"},
+    };
+    for (auto [path, file] : cases) {
+        HttpRequest request;
+        HttpResponse response;
+        string p = path;
+        response.Init(".", p);
+        RouteMatch match;
+        assert(router.Match(path, match));
+        match.route->handler->Handle(request, match, response);
+        assert(response.path == file);
+    }
+
+    HttpRequest request;
+    HttpResponse response;
+    string p = "/metrics";
+    response.Init(".", p);
+    RouteMatch match;
+    assert(router.Match(p, match));
+    match.route->handler->Handle(request, match, response);
+    Buffer buff;
+    response.MakeResponse(buff);
+    string text = buff.RetrieveAll();
+    cout << text << "\n";
+    assert(response.Code() == 200 && text.find("Content-type: text/plain") != string::npos);
+    assert(text.find("requests_total 8\n") != string::npos);
+    assert(text.find("route_requests{route=\"/*\"} 2\n") != string::npos);
+    cout << "Built-in routes OK\n";
+}
+
+int main() {
+    testPriority();
+    testInvalid();
+    testMany();
+    testBuiltin();
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <exception>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <mutex>
 #include <thread>
@@ -39,37 +40,37 @@ namespace bre
   {
   public:
     template <typename... Args>
-    static void fatal(const std::string &format, Args &&...args)
+    static void fatal(std::string_view format, Args &&...args)
     {
       Instance().Write(LogLevel::FATAL, format, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
-    static void err(const std::string &format, Args &&...args)
+    static void err(std::string_view format, Args &&...args)
     {
       Instance().Write(LogLevel::ERROR, format, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
-    static void warn(const std::string &format, Args &&...args)
+    static void warn(std::string_view format, Args &&...args)
     {
       Instance().Write(LogLevel::WARN, format, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
-    static void info(const std::string &format, Args &&...args)
+    static void info(std::string_view format, Args &&...args)
     {
       Instance().Write(LogLevel::INFO, format, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
-    static void debug(const std::string &format, Args &&...args)
+    static void debug(std::string_view format, Args &&...args)
     {
       Instance().Write(LogLevel::DEBUG, format, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
-    static void trace(const std::string &format, Args &&...args)
+    static void trace(std::string_view format, Args &&...args)
     {
       Instance().Write(LogLevel::TRACE, format, std::forward<Args>(args)...);
     }
@@ -162,7 +163,7 @@ namespace bre
     }
 
     template <typename... Args>
-    void Write(LogLevel level, const std::string &format, Args &&...args)
+    void Write(LogLevel level, std::string_view format, Args &&...args)
     {
       if (!isOpen || level < GetLevel())
       {
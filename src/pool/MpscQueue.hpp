@@ -0,0 +1,68 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+
+namespace bre {
+
+// 侵入式节点，使用者继承后携带数据
+struct MpscNode {
+    std::atomic<MpscNode*> next{nullptr};
+};
+
+// 无锁多生产者单消费者队列（Vyukov 侵入式算法）
+// Push 任意线程调用，一次 exchange 即完成；Pop 只允许一个消费者
+// 生产者正在 Push 的瞬间 Pop 可能暂时返回 nullptr，调用方按需重试
+class MpscQueue {
+public:
+    MpscQueue() : head(&stub), tail(&stub) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void Push(MpscNode* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    MpscNode* Pop() {
+        MpscNode* t = tail;
+        MpscNode* next = t->next.load(std::memory_order_acquire);
+        if (t == &stub) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            tail = next;
+            t = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            tail = next;
+            return t;
+        }
+        if (t != head.load(std::memory_order_acquire)) {
+            return nullptr;     // 有生产者尚未完成链接
+        }
+        Push(&stub);
+        next = t->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            tail = next;
+            return t;
+        }
+        return nullptr;
+    }
+
+    // 近似判空，只在消费者线程使用
+    bool Empty() const {
+        return tail == &stub && stub.next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    std::atomic<MpscNode*> head;    // 生产者端
+    MpscNode* tail;                 // 消费者端
+    MpscNode stub;
+};
+
+} // namespace bre
+#endif // MPSC_QUEUE_H
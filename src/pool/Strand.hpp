@@ -0,0 +1,82 @@
+#ifndef STRAND_H
+#define STRAND_H
+
+#include "ThreadPool.hpp"
+#include "MpscQueue.hpp"
+#include "Task.hpp"
+
+#include <atomic>
+#include <thread>
+#include <utility>
+
+namespace bre {
+
+// 串行执行器：投递到同一个 Strand 的任务按顺序执行，任意时刻最多一个线程在执行
+// 快速路径无锁：投递为一次 exchange + 一次 fetch_add；
+// 只有从空闲变为忙碌的那次投递才会把 run() 交给线程池
+class Strand {
+public:
+    Strand() = default;
+
+    ~Strand() {
+        while (MpscNode* node = queue.Pop()) {
+            TaskNodePool::Instance().Free(static_cast<TaskNode*>(node));
+        }
+    }
+
+    Strand(const Strand&) = delete;
+    Strand& operator=(const Strand&) = delete;
+
+    // 排队执行，总是在线程池中运行
+    template<typename Func>
+    void Post(ThreadPool& pool, Func&& f) {
+        queue.Push(TaskNodePool::Instance().Alloc(std::forward<Func>(f)));
+        executor.store(&pool, std::memory_order_relaxed);
+        if (pending.fetch_add(1, std::memory_order_acq_rel) == 0) {
+            pool.enqueue([this] { run(); });
+        }
+    }
+
+    // 空闲时在当前线程直接执行，否则排在已有任务之后
+    template<typename Func>
+    void Dispatch(ThreadPool& pool, Func&& f) {
+        size_t idle = 0;
+        if (!pending.compare_exchange_strong(idle, 1, std::memory_order_acq_rel)) {
+            Post(pool, std::forward<Func>(f));
+            return;
+        }
+        executor.store(&pool, std::memory_order_relaxed);
+        f();
+        // 执行期间有新任务投递，交给线程池继续
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+            pool.enqueue([this] { run(); });
+        }
+    }
+
+private:
+    // 每次最多执行 BATCH 个任务后让出线程，避免一个繁忙的 Strand 占住工作线程
+    void run() {
+        for (int i = 0; i < BATCH; ++i) {
+            MpscNode* node;
+            while ((node = queue.Pop()) == nullptr) {
+                std::this_thread::yield();  // pending > 0，生产者正在链接节点
+            }
+            TaskNode* taskNode = static_cast<TaskNode*>(node);
+            taskNode->task();
+            TaskNodePool::Instance().Free(taskNode);
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                return;
+            }
+        }
+        executor.load(std::memory_order_relaxed)->enqueue([this] { run(); });
+    }
+
+    static const int BATCH = 16;
+
+    MpscQueue queue;
+    std::atomic<size_t> pending{0};     // 已投递未完成的任务数（含正在执行的）
+    std::atomic<ThreadPool*> executor{nullptr};
+};
+
+} // namespace bre
+#endif // STRAND_H
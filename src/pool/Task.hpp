@@ -0,0 +1,178 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include "MpscQueue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace bre {
+
+// 只可移动的任务类型，可调用对象直接存放在内部固定大小的缓冲区中，从不分配堆内存
+// 放不下的可调用对象在编译期报错：改为按指针捕获或减少捕获
+class Task {
+public:
+    static constexpr size_t INLINE_SIZE = 64;
+
+    Task() = default;
+
+    template<typename F, typename Fn = std::decay_t<F>,
+             typename = std::enable_if_t<!std::is_same_v<Fn, Task>>>
+    Task(F&& f) {
+        static_assert(sizeof(Fn) <= INLINE_SIZE,
+                      "Task: callable is larger than Task::INLINE_SIZE, capture by pointer instead");
+        static_assert(alignof(Fn) <= alignof(std::max_align_t),
+                      "Task: callable is over-aligned");
+        static_assert(std::is_nothrow_move_constructible_v<Fn>,
+                      "Task: callable must be nothrow move constructible");
+        ::new (static_cast<void*>(storage)) Fn(std::forward<F>(f));
+        ops = &opsFor<Fn>;
+    }
+
+    Task(Task&& other) noexcept {
+        moveFrom(other);
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        reset();
+    }
+
+    void operator()() {
+        ops->invoke(storage);
+    }
+
+    explicit operator bool() const {
+        return ops != nullptr;
+    }
+
+    void reset() {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void*);
+        void (*move)(void* dst, void* src);
+        void (*destroy)(void*);
+    };
+
+    template<typename Fn>
+    static constexpr Ops opsFor = {
+        [](void* p) { (*static_cast<Fn*>(p))(); },
+        [](void* dst, void* src) {
+            ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* p) { static_cast<Fn*>(p)->~Fn(); },
+    };
+
+    void moveFrom(Task& other) {
+        ops = other.ops;
+        if (ops) {
+            ops->move(storage, other.storage);
+            other.ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[INLINE_SIZE];
+    const Ops* ops = nullptr;
+};
+
+// 线程池和 Strand 队列中的节点
+struct TaskNode : MpscNode {
+    Task task;
+    uint32_t index = 0;     // 在 TaskNodePool 中的位置 + 1，0 表示池耗尽时从堆上分配
+    std::atomic<uint32_t> nextFree{0};
+};
+
+// 预分配的任务节点池，空闲链表为带版本号的无锁栈（避免 ABA）
+// 稳态下入队不分配内存；池耗尽时退化为堆分配
+class TaskNodePool {
+public:
+    static const uint32_t CAPACITY = 16384;
+
+    static TaskNodePool& Instance() {
+        static TaskNodePool instance;
+        return instance;
+    }
+
+    template<typename F>
+    TaskNode* Alloc(F&& f) {
+        TaskNode* node = pop();
+        if (node == nullptr) {
+            node = new TaskNode();
+        }
+        node->task = Task(std::forward<F>(f));
+        return node;
+    }
+
+    void Free(TaskNode* node) {
+        node->task.reset();
+        if (node->index == 0) {
+            delete node;
+            return;
+        }
+        push(node);
+    }
+
+private:
+    TaskNodePool() : nodes(new TaskNode[CAPACITY]) {
+        for (uint32_t i = 0; i < CAPACITY; ++i) {
+            nodes[i].index = i + 1;
+            nodes[i].nextFree.store(i + 2 <= CAPACITY ? i + 2 : 0, std::memory_order_relaxed);
+        }
+        head.store(1, std::memory_order_release);
+    }
+
+    // head: 高 32 位为版本号，低 32 位为栈顶节点的 index（0 为空）
+    TaskNode* pop() {
+        uint64_t old = head.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t index = static_cast<uint32_t>(old);
+            if (index == 0) {
+                return nullptr;
+            }
+            TaskNode* node = &nodes[index - 1];
+            uint64_t next = ((old >> 32) + 1) << 32 | node->nextFree.load(std::memory_order_relaxed);
+            if (head.compare_exchange_weak(old, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return node;
+            }
+        }
+    }
+
+    void push(TaskNode* node) {
+        uint64_t old = head.load(std::memory_order_relaxed);
+        for (;;) {
+            node->nextFree.store(static_cast<uint32_t>(old), std::memory_order_relaxed);
+            uint64_t next = ((old >> 32) + 1) << 32 | node->index;
+            if (head.compare_exchange_weak(old, next, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    std::unique_ptr<TaskNode[]> nodes;
+    alignas(64) std::atomic<uint64_t> head{0};
+};
+
+} // namespace bre
+#endif // TASK_H
@@ -1,76 +1,213 @@
 #ifndef THREADPOOL_H
 #define THREADPOOL_H
 
-#include <mutex>
-#include <condition_variable>
-#include <queue>
+#include "MpscQueue.hpp"
+#include "WorkStealingDeque.hpp"
+#include "Task.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <thread>
 #include <functional>
 #include <vector>
 namespace bre{
+
+// 工作窃取线程池
+// 每个工作线程有一个 Chase-Lev 双端队列（自己提交的任务）和一个无锁收件箱（外部线程提交的任务）
+// 空闲时随机选择其他线程窃取，先自旋再休眠；整个池没有全局锁
 class ThreadPool {
 public:
     ThreadPool(size_t threadCount = std::thread::hardware_concurrency()) : stop(false) {
         if (threadCount == 0) {
             threadCount = 8;
         }
+        workers.reserve(threadCount);
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back(new Worker());
+        }
         threads.reserve(threadCount);
         for (size_t i = 0; i < threadCount; ++i) {
-            threads.emplace_back([this] { this->worker(); });
+            threads.emplace_back([this, i] { this->worker(i); });
         }
     }
 
     ~ThreadPool() {
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex);
-            stop = true;
-        }
-        condition.notify_all();
+        stop.store(true, std::memory_order_seq_cst);
+        wakeSeq.fetch_add(1, std::memory_order_seq_cst);
+        wakeSeq.notify_all();
 
         for (std::thread &worker : threads) {
             worker.join();
         }
+        // 停止后才入队的任务不再执行
+        for (auto &w : workers) {
+            while (TaskNode* node = w->deque.Pop()) {
+                TaskNodePool::Instance().Free(node);
+            }
+            while (MpscNode* node = w->inbox.Pop()) {
+                TaskNodePool::Instance().Free(static_cast<TaskNode*>(node));
+            }
+        }
     }
 
     template<typename Func, typename... Args>
     void enqueue(Func &&f, Args &&...args) {
-        std::function<void()> task = std::bind(std::forward<Func>(f), std::forward<Args>(args)...);
-
-        { // queue_mutex
-            std::lock_guard<std::mutex> lock(queue_mutex);
+        if (stop.load(std::memory_order_relaxed)) {
+            return;
+        }
+        // 不经过 std::bind / std::function：可调用对象和参数直接放进节点内的 Task，节点来自预分配池
+        TaskNode* node;
+        if constexpr (sizeof...(Args) == 0) {
+            node = TaskNodePool::Instance().Alloc(std::forward<Func>(f));
+        } else {
+            node = TaskNodePool::Instance().Alloc(
+                [f = std::forward<Func>(f), ... args = std::forward<Args>(args)]() mutable {
+                    std::invoke(f, args...);
+                });
+        }
 
-            if (stop) {
-                return;
-            }
-            tasks.emplace(std::move(task));
-        } // queue_mutex
-        condition.notify_one();
+        if (currentPool == this && workers[currentIndex]->deque.Push(node)) {
+            // 工作线程内提交：放进自己的队列，由自己或窃取者执行
+        } else {
+            // 外部线程提交（或自己的队列已满）：轮流投递到各工作线程的收件箱
+            size_t i = currentPool == this ? currentIndex
+                                           : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+            workers[i]->inbox.Push(node);
+            workers[i]->inboxSize.fetch_add(1, std::memory_order_seq_cst);
+        }
+        notify();
     }
 
 private:
-    void worker() {
-        for (;;) {
-            std::function<void()> task;
-            {
-                std::unique_lock<std::mutex> lock(queue_mutex);
-                condition.wait(lock, [this] { return stop || !tasks.empty(); });
+    struct Worker {
+        WorkStealingDeque<TaskNode> deque;
+        MpscQueue inbox;
+        std::atomic<int> inboxSize{0};
+        std::atomic<bool> inboxBusy{false};    // 收件箱的消费权，任何线程抢到后都可以取
+    };
 
-                if (stop && tasks.empty())
+    void worker(size_t self) {
+        currentPool = this;
+        currentIndex = self;
+        uint64_t seed = self * 0x9E3779B97F4A7C15ULL + 1;
+        int idle = 0;
+        for (;;) {
+            TaskNode* node = findTask(self, seed);
+            if (node) {
+                idle = 0;
+                node->task();
+                TaskNodePool::Instance().Free(node);
+                continue;
+            }
+            if (stop.load(std::memory_order_acquire)) {
+                if (!hasWork()) {
                     return;
+                }
+                continue;
+            }
+            // 先自旋一段时间，仍然没有任务再休眠
+            if (++idle < SPIN_COUNT) {
+                std::this_thread::yield();
+                continue;
+            }
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            uint32_t seq = wakeSeq.load(std::memory_order_seq_cst);
+            if (!hasWork() && !stop.load(std::memory_order_seq_cst)) {
+                wakeSeq.wait(seq, std::memory_order_seq_cst);
+            }
+            sleepers.fetch_sub(1, std::memory_order_seq_cst);
+            idle = 0;
+        }
+    }
 
-                task = std::move(tasks.front());
-                tasks.pop();
+    TaskNode* findTask(size_t self, uint64_t &seed) {
+        Worker &own = *workers[self];
+        if (TaskNode* node = own.deque.Pop()) {
+            return node;
+        }
+        if (TaskNode* node = takeInbox(own, own)) {
+            return node;
+        }
+        // 从随机位置开始依次尝试窃取
+        size_t n = workers.size();
+        size_t start = nextRandom(seed) % n;
+        for (size_t k = 0; k < n; ++k) {
+            size_t victim = (start + k) % n;
+            if (victim == self) {
+                continue;
+            }
+            if (TaskNode* node = workers[victim]->deque.Steal()) {
+                return node;
+            }
+            if (TaskNode* node = takeInbox(*workers[victim], own)) {
+                return node;
             }
-            task();
         }
+        return nullptr;
     }
 
+    // 抢到收件箱的消费权后取出一批任务：返回第一个，其余放进自己的队列
+    TaskNode* takeInbox(Worker &from, Worker &own) {
+        if (from.inboxSize.load(std::memory_order_seq_cst) <= 0 ||
+            from.inboxBusy.exchange(true, std::memory_order_acquire)) {
+            return nullptr;
+        }
+        TaskNode* first = nullptr;
+        for (int i = 0; i < INBOX_BATCH; ++i) {
+            MpscNode* node = from.inbox.Pop();
+            if (node == nullptr) {
+                break;
+            }
+            from.inboxSize.fetch_sub(1, std::memory_order_seq_cst);
+            TaskNode* task = static_cast<TaskNode*>(node);
+            if (first == nullptr) {
+                first = task;
+            } else if (!own.deque.Push(task)) {
+                own.inbox.Push(task);
+                own.inboxSize.fetch_add(1, std::memory_order_seq_cst);
+            }
+        }
+        from.inboxBusy.store(false, std::memory_order_release);
+        return first;
+    }
+
+    bool hasWork() const {
+        for (auto &w : workers) {
+            if (!w->deque.Empty() || w->inboxSize.load(std::memory_order_seq_cst) > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void notify() {
+        if (sleepers.load(std::memory_order_seq_cst) > 0) {
+            wakeSeq.fetch_add(1, std::memory_order_seq_cst);
+            wakeSeq.notify_one();
+        }
+    }
+
+    static uint64_t nextRandom(uint64_t &x) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    }
+
+    static const int SPIN_COUNT = 64;
+    static const int INBOX_BATCH = 32;
+
+    inline static thread_local ThreadPool* currentPool = nullptr;
+    inline static thread_local size_t currentIndex = 0;
+
+    std::vector<std::unique_ptr<Worker>> workers;
     std::vector<std::thread> threads;
-    std::queue<std::function<void()>> tasks;
-    std::mutex queue_mutex;
-    std::condition_variable condition;
-    bool stop;
+    std::atomic<size_t> nextWorker{0};
+    std::atomic<int> sleepers{0};
+    std::atomic<uint32_t> wakeSeq{0};
+    std::atomic<bool> stop;
 };
 
 } // namespace bre
-#endif //THREADPOOL_H
\ No newline at end of file
+#endif //THREADPOOL_H
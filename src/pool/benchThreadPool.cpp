@@ -0,0 +1,142 @@
+// 线程池争用测试：工作窃取线程池 vs 旧版单队列线程池（一把锁 + 一个条件变量）
+// 场景一：4 个外部线程并发提交空任务（对应反应堆线程投递读写事件）
+// 场景二：工作线程内部再提交子任务（扇出）
+// g++ -std=c++20 -O2 benchThreadPool.cpp -o benchThreadPool -pthread
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <thread>
+#include <functional>
+#include <vector>
+#include "ThreadPool.hpp"
+
+using namespace bre;
+
+// 旧版实现，仅用于对比
+class LockQueuePool {
+public:
+    LockQueuePool(size_t threadCount) : stop(false) {
+        for (size_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back([this] { this->worker(); });
+        }
+    }
+
+    ~LockQueuePool() {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            stop = true;
+        }
+        condition.notify_all();
+        for (std::thread &worker : threads) {
+            worker.join();
+        }
+    }
+
+    template<typename Func, typename... Args>
+    void enqueue(Func &&f, Args &&...args) {
+        std::function<void()> task = std::bind(std::forward<Func>(f), std::forward<Args>(args)...);
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (stop) {
+                return;
+            }
+            tasks.emplace(std::move(task));
+        }
+        condition.notify_one();
+    }
+
+private:
+    void worker() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                condition.wait(lock, [this] { return stop || !tasks.empty(); });
+                if (stop && tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::queue<std::function<void()>> tasks;
+    std::mutex queue_mutex;
+    std::condition_variable condition;
+    bool stop;
+};
+
+const int PRODUCERS = 4;
+const int TASKS_PER_PRODUCER = 100000;
+const int FANOUT_ROOTS = 2000;
+const int FANOUT_CHILDREN = 100;
+
+template<typename Pool>
+double benchExternal(size_t threadCount) {
+    std::atomic<int> done{0};
+    const int total = PRODUCERS * TASKS_PER_PRODUCER;
+    auto start = std::chrono::steady_clock::now();
+    {
+        Pool pool(threadCount);
+        std::vector<std::thread> producers;
+        for (int p = 0; p < PRODUCERS; ++p) {
+            producers.emplace_back([&] {
+                for (int i = 0; i < TASKS_PER_PRODUCER; ++i) {
+                    pool.enqueue([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+                }
+            });
+        }
+        for (auto &t : producers) {
+            t.join();
+        }
+        while (done.load() < total) {
+            std::this_thread::yield();
+        }
+    }
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return total / d.count();
+}
+
+template<typename Pool>
+double benchFanout(size_t threadCount) {
+    std::atomic<int> done{0};
+    const int total = FANOUT_ROOTS * FANOUT_CHILDREN;
+    auto start = std::chrono::steady_clock::now();
+    {
+        Pool pool(threadCount);
+        for (int r = 0; r < FANOUT_ROOTS; ++r) {
+            pool.enqueue([&pool, &done] {
+                for (int c = 0; c < FANOUT_CHILDREN; ++c) {
+                    pool.enqueue([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+                }
+            });
+        }
+        while (done.load() < total) {
+            std::this_thread::yield();
+        }
+    }
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    return total / d.count();
+}
+
+int main() {
+    std::cout << "tasks/sec (M)\n"
+              << std::setw(8) << "threads"
+              << std::setw(14) << "lock/ext" << std::setw(14) << "steal/ext"
+              << std::setw(14) << "lock/fanout" << std::setw(14) << "steal/fanout" << "\n";
+    std::cout << std::fixed << std::setprecision(2);
+    for (size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        std::cout << std::setw(8) << threads
+                  << std::setw(14) << benchExternal<LockQueuePool>(threads) / 1e6
+                  << std::setw(14) << benchExternal<ThreadPool>(threads) / 1e6
+                  << std::setw(14) << benchFanout<LockQueuePool>(threads) / 1e6
+                  << std::setw(14) << benchFanout<ThreadPool>(threads) / 1e6 << std::endl;
+    }
+    return 0;
+}
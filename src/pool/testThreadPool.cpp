@@ -1,14 +1,112 @@
 #include <iostream>
 #include <chrono>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include <vector>
 #include "ThreadPool.hpp"
+#include "Strand.hpp"
 using namespace bre;
+
+// 统计全局 operator new 调用次数，用于检查入队是否分配内存
+static std::atomic<size_t> allocCount{0};
+void* operator new(size_t size) {
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
 void testTask(int id) {
     std::cout << "Executing task " << id << " on thread " 
               << std::this_thread::get_id() << std::endl;
     std::this_thread::sleep_for(std::chrono::milliseconds(200)); // 模拟耗时操作
 }
 
+// 多个线程同时向同一个 Strand 投递，任务串行执行，非原子计数不会丢失
+void testStrand() {
+    ThreadPool pool(4);
+    Strand strand;
+    int counter = 0;
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+    const int producers = 4, perProducer = 10000;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producers; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < perProducer; ++j) {
+                auto task = [&] {
+                    if (running.fetch_add(1) != 0) {
+                        overlapped = true;
+                    }
+                    ++counter;
+                    running.fetch_sub(1);
+                };
+                if (j % 2) {
+                    strand.Post(pool, task);
+                } else {
+                    strand.Dispatch(pool, task);
+                }
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    while (true) {
+        std::atomic<bool> done{false};
+        strand.Post(pool, [&] { done = true; });
+        while (!done) {
+            std::this_thread::yield();
+        }
+        if (counter == producers * perProducer) {
+            break;
+        }
+    }
+    assert(!overlapped);
+    std::cout << "Strand executed " << counter << " tasks serially." << std::endl;
+}
+
+// 稳态下投递到线程池和 Strand 不分配堆内存
+void testNoAllocation() {
+    ThreadPool pool(4);
+    Strand strand;
+    std::atomic<int> done{0};
+    const int tasks = TaskNodePool::CAPACITY / 4;   // 不超过池容量，超出部分会退化为堆分配
+    struct Conn { int id; } conn{1};
+    Conn* client = &conn;
+
+    // 预热：TaskNodePool 在第一次使用时创建
+    pool.enqueue([&done] { done.fetch_add(1); });
+    while (done.load() < 1) {
+        std::this_thread::yield();
+    }
+    done = 0;
+
+    size_t before = allocCount.load();
+    for (int i = 0; i < tasks; ++i) {
+        pool.enqueue([&done, client] { done.fetch_add(client->id); });
+        strand.Post(pool, [&done, client] { done.fetch_add(client->id); });
+    }
+    size_t after = allocCount.load();
+    while (done.load() < 2 * tasks) {
+        std::this_thread::yield();
+    }
+    assert(after == before);
+    std::cout << "Enqueued " << 2 * tasks << " tasks with " << after - before << " allocations." << std::endl;
+}
+
 int main() {
+    testStrand();
+    testNoAllocation();
+
     ThreadPool pool(4);
 
     for (int i = 0; i < 10; ++i) {
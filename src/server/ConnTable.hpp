@@ -0,0 +1,80 @@
+#ifndef CONN_TABLE_HPP
+#define CONN_TABLE_HPP
+
+#include "../http/HttpConn.hpp"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace bre
+{
+
+    // 以 fd 为下标的连接表，替代 unordered_map<int, HttpConn>
+    // 按固定大小的块懒分配，块一旦分配不再移动，工作线程持有的 HttpConn* 始终有效
+    // 各反应堆共享同一张表（fd 在进程内唯一），块的分配用 CAS 保证线程安全
+    class ConnTable
+    {
+    public:
+        static const int CHUNK_SIZE = 256;
+
+        explicit ConnTable(int maxFd)
+            : maxFd(maxFd), chunkCount((maxFd + CHUNK_SIZE - 1) / CHUNK_SIZE),
+              chunks(new std::atomic<HttpConn *>[chunkCount])
+        {
+            for (int i = 0; i < chunkCount; ++i)
+            {
+                chunks[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        ~ConnTable()
+        {
+            for (int i = 0; i < chunkCount; ++i)
+            {
+                delete[] chunks[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        ConnTable(const ConnTable &) = delete;
+        ConnTable &operator=(const ConnTable &) = delete;
+
+        // 获取 fd 对应的连接，所在块不存在时分配
+        HttpConn &Get(int fd)
+        {
+            if (fd < 0 || fd >= maxFd)
+            {
+                throw std::out_of_range("ConnTable::Get: fd out of range: " + std::to_string(fd));
+            }
+            auto &slot = chunks[fd / CHUNK_SIZE];
+            HttpConn *chunk = slot.load(std::memory_order_acquire);
+            if (chunk == nullptr)
+            {
+                HttpConn *fresh = new HttpConn[CHUNK_SIZE];
+                if (slot.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel))
+                {
+                    chunk = fresh;
+                }
+                else
+                { // 其他反应堆已经分配
+                    delete[] fresh;
+                }
+            }
+            return chunk[fd % CHUNK_SIZE];
+        }
+
+        int MaxFd() const
+        {
+            return maxFd;
+        }
+
+    private:
+        int maxFd;
+        int chunkCount;
+        std::unique_ptr<std::atomic<HttpConn *>[]> chunks;
+    };
+
+} // namespace bre
+
+#endif // CONN_TABLE_HPP
@@ -0,0 +1,414 @@
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include "epoller.hpp"
+#include "../mylog/Log.hpp"
+#include "../timer/Timer.hpp"
+#include "../pool/ThreadPool.hpp"
+#include "../pool/Strand.hpp"
+#include "../http/HttpConn.hpp"
+#include "ConnTable.hpp"
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <memory>
+#include <functional>
+#include <atomic>
+
+#include <fcntl.h>
+#include <sys/socket.h> // accept
+#include <netinet/in.h> // sockaddr_in
+#include <arpa/inet.h>  // inet_ntoa
+
+namespace bre
+{
+
+    // 子反应堆：独占一个 Epoller、一个定时器和自己的监听套接字
+    // 多个 Reactor 通过 SO_REUSEPORT 监听同一端口，由内核分发新连接
+    class Reactor
+    {
+    public:
+        Reactor(int id, int listenFd, uint32_t listenEvent, uint32_t connEvent,
+                int timeoutMS, bool inlineMode, std::unique_ptr<Timer> timer,
+                ThreadPool &threadpool, ConnTable &users)
+            : id(id), listenFd(listenFd), listenEvent(listenEvent), connEvent(connEvent),
+              timeoutMS(timeoutMS), inlineMode(inlineMode), isClose(false), epoller(new Epoller()),
+              timer(std::move(timer)), threadpool(threadpool), users(users)
+        {
+            // 监听套接字以 &listenFd、timerfd 以 &timerDeadline 作为标记，其余事件的 data.ptr 均为 HttpConn*
+            if (!epoller->AddFd(listenFd, EPOLLIN | listenEvent, &this->listenFd))
+            {
+                throw std::runtime_error("add listen fd to epoller error");
+            }
+            if (!epoller->AddTimerFd(&timerDeadline))
+            {
+                throw std::runtime_error("add timerfd to epoller error");
+            }
+        }
+
+        ~Reactor()
+        {
+            close(listenFd);
+        }
+
+        Reactor(const Reactor &) = delete;
+        Reactor &operator=(const Reactor &) = delete;
+
+        void Loop()
+        {
+            Log::info("Reactor[{}] start, listenFd: {}", id, listenFd);
+            while (!isClose)
+            {
+                // 定时器到期由 timerfd 以普通事件通知，空闲时无限期阻塞
+                int eventCnt = epoller->Wait(-1);
+                loopTime = NowMs();
+                for (int i = 0; i < eventCnt; ++i)
+                {
+                    void *ptr = epoller->GetEventPtr(i);
+                    uint32_t events = epoller->GetEvents(i);
+                    if (ptr == &listenFd)
+                    {
+                        dealListen();
+                        continue;
+                    }
+                    if (ptr == &timerDeadline)
+                    {
+                        epoller->ReadTimerFd();
+                        timerDeadline = INT64_MAX;
+                        timerDirty = true;
+                        continue;
+                    }
+                    HttpConn *client = static_cast<HttpConn *>(ptr);
+                    assert(client != nullptr);
+                    if (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                    {
+                        dealClose(client, client->Generation());
+                    }
+                    else if (events & EPOLLIN)
+                    {
+                        dealRead(client);
+                    }
+                    else if (events & EPOLLOUT)
+                    {
+                        dealWrite(client);
+                    }
+                    else
+                    {
+                        Log::err("Unexpected event");
+                    }
+                }
+                armTimer();
+            }
+        }
+
+        void Stop()
+        {
+            isClose = true;
+            epoller->ArmTimerFd(0); // 唤醒阻塞中的 Wait
+        }
+
+    private:
+        void addClient(int fd, sockaddr_in addr)
+        {
+            if (fd < 0)
+            {
+                Log::err("fd error");
+                return;
+            }
+            HttpConn *client = &users.Get(fd);
+            client->Init(fd, addr);
+            client->Touch(loopTime);
+            if (timeoutMS > 0)
+            {
+                // 同一 fd 上一个连接残留的定时任务：Add 只会调整时间，不会换成新连接的回调
+                timer->Cancel(fd);
+                timer->Add(fd, timeoutMS,
+                           std::bind(&Reactor::dealIdle, this, client, client->Generation()));
+                timerDirty = true;
+            }
+            epoller->AddFd(fd, connEvent | EPOLLIN, client);
+            setFdNonblock(fd);
+            Log::info("Client[{}]({}:{}) in, fd: {}, reactor: {}",
+                      HttpConn::UserCount.load(), inet_ntoa(addr.sin_addr),
+                      ntohs(addr.sin_port), fd, id);
+        }
+
+        void dealListen()
+        {
+            sockaddr_in addr;
+            socklen_t len = sizeof(addr);
+            do
+            {
+                int fd = accept(listenFd, (sockaddr *)&addr, &len);
+                if (fd <= 0)
+                { // 连接失败
+                    return;
+                }
+                else if (HttpConn::UserCount >= users.MaxFd() || fd >= users.MaxFd())
+                {
+                    sendError(fd, "Server busy");
+                    Log::warn("Clients is full");
+                    return;
+                }
+                addClient(fd, addr);
+            } while (listenEvent & EPOLLET);
+        }
+
+        void dealWrite(HttpConn *client)
+        {
+            if (client == nullptr)
+            {
+                Log::err("client is nullptr");
+                throw std::invalid_argument("client is nullptr");
+            }
+            extentTime(client);
+            if (inlineMode)
+            { // 非阻塞写，直接在反应堆线程完成
+                client->GetStrand().Dispatch(threadpool, [this, client] { onWrite(client); });
+                return;
+            }
+            client->GetStrand().Post(threadpool, [this, client] { onWrite(client); });
+        }
+
+        void dealRead(HttpConn *client)
+        {
+            if (client == nullptr)
+            {
+                Log::err("client is nullptr");
+                throw std::invalid_argument("client is nullptr");
+            }
+            extentTime(client);
+            if (inlineMode)
+            {
+                client->GetStrand().Dispatch(threadpool, [this, client] { onReadInline(client); });
+                return;
+            }
+            client->GetStrand().Post(threadpool, [this, client] { onRead(client); });
+        }
+
+        void sendError(int fd, const char *info)
+        {
+            int ret = send(fd, info, strlen(info), 0);
+            if (ret < 0)
+            {
+                Log::err("send error to client error");
+            }
+            close(fd);
+        }
+
+        // timerfd 到期或添加了定时任务后：处理到期任务，最早到期时间提前时才重新设置 timerfd
+        void armTimer()
+        {
+            if (!timerDirty || timeoutMS <= 0)
+            {
+                return;
+            }
+            timerDirty = false;
+            MS next = timer->GetNextTick();
+            int64_t deadline = next == MS::max() ? INT64_MAX : loopTime + next.count();
+            // 更晚的到期时间不必重设：timerfd 提前到期时会再来这里
+            if (deadline < timerDeadline)
+            {
+                epoller->ArmTimerFd(next == MS::max() ? -1 : next.count());
+                timerDeadline = deadline;
+            }
+        }
+
+        // 只记录活动时间，不调整定时器；到期时再由 dealIdle 检查
+        void extentTime(HttpConn *client)
+        {
+            if (client == nullptr)
+            {
+                Log::err("client is nullptr");
+                throw std::invalid_argument("client is nullptr");
+            }
+            client->Touch(loopTime);
+        }
+
+        // 定时器到期：期间有过活动则按剩余时间重新定时，否则关闭
+        // 连接可能已在工作线程中关闭，fd 又被其他反应堆复用（连接表共享），此时 generation 已变，丢弃该任务
+        void dealIdle(HttpConn *client, uint64_t gen)
+        {
+            if (client->Generation() != gen)
+            {
+                return;
+            }
+            int64_t idle = loopTime - client->LastActive();
+            if (idle < timeoutMS)
+            {
+                timer->Add(client->GetFd(), static_cast<int>(timeoutMS - idle),
+                           std::bind(&Reactor::dealIdle, this, client, gen));
+                return;
+            }
+            dealClose(client, gen);
+        }
+
+        // 超时或对端关闭：排在该连接正在执行的任务之后关闭，空闲时直接关闭
+        // 关闭都在 strand 中执行，轮到时 generation 未变说明还是同一个连接
+        void dealClose(HttpConn *client, uint64_t gen)
+        {
+            client->GetStrand().Dispatch(threadpool, [this, client, gen]
+                                         {
+                                             if (client->Generation() == gen)
+                                             {
+                                                 closeConn(client);
+                                             } });
+        }
+
+        void closeConn(HttpConn *client)
+        {
+            if (client == nullptr)
+            {
+                Log::err("client is nullptr");
+                throw std::invalid_argument("client is nullptr");
+            }
+            if (client->IsClose())
+            {   // fd 可能已被新连接复用，不能再 DelFd
+                return;
+            }
+            // Log::info("Client close fd: {}", client->GetFd());
+            epoller->DelFd(client->GetFd());
+            client->Close();
+        }
+
+        void onRead(HttpConn *client)
+        {
+            if (client == nullptr)
+            {
+                Log::err("client is nullptr");
+                throw std::invalid_argument("client is nullptr");
+            }
+            int ret = -1;
+            int readErrno = 0;
+            ret = client->Read(&readErrno);
+            if (ret <= 0 && readErrno != EAGAIN)
+            {
+                closeConn(client);
+                return;
+            }
+            onProcess(client);
+        }
+
+        void onWrite(HttpConn *client)
+        {
+            if (client == nullptr)
+            {
+                Log::err("client is nullptr");
+                throw std::invalid_argument("client is nullptr");
+            }
+            int ret = -1;
+            int writeErrno = 0;
+            ret = client->Write(&writeErrno);
+            if (client->ToWriteBytes() == 0)
+            {
+                if (client->IsKeepAlive())
+                {
+                    if (inlineMode)
+                    {
+                        processInline(client);
+                    }
+                    else
+                    {
+                        onProcess(client);
+                    }
+                    return;
+                }
+                // 短连接：响应已发送完毕
+                closeConn(client);
+                return;
+            }
+            if (ret < 0 && writeErrno != EAGAIN)
+            {
+                Log::err("send data error");
+                closeConn(client);
+                return;
+            }
+            // 未发送完（EAGAIN 或水平触发下写了一部分），等待可写
+            epoller->ModFd(client->GetFd(), connEvent | EPOLLOUT, client);
+        }
+
+        void onProcess(HttpConn *client)
+        {
+            if (client == nullptr)
+            {
+                Log::err("client is nullptr");
+                throw std::invalid_argument("client is nullptr");
+            }
+            if (client->Process())
+            {
+                epoller->ModFd(client->GetFd(), connEvent | EPOLLOUT, client);
+            }
+            else
+            {
+                epoller->ModFd(client->GetFd(), connEvent | EPOLLIN, client);
+            }
+        }
+
+        // 运行到完成模式：在反应堆线程内读取、解析并写回
+        // 可能阻塞的请求（登录注册需要查询 MySQL，文件未缓存）才交给线程池
+        void onReadInline(HttpConn *client)
+        {
+            int readErrno = 0;
+            ssize_t ret = client->Read(&readErrno);
+            if (ret <= 0 && readErrno != EAGAIN)
+            {
+                closeConn(client);
+                return;
+            }
+            processInline(client);
+        }
+
+        // 先处理不会阻塞的请求，Process 在可能阻塞的请求前停下；之前的响应发送完后再经过这里交给线程池
+        void processInline(HttpConn *client)
+        {
+            if (!client->MayBlock())
+            {
+                if (client->Process(false))
+                {
+                    onWrite(client);
+                    return;
+                }
+                if (!client->MayBlock())
+                {
+                    epoller->ModFd(client->GetFd(), connEvent | EPOLLIN, client);
+                    return;
+                }
+            }
+            client->GetStrand().Post(threadpool, [this, client] { onProcess(client); });
+        }
+
+        static int setFdNonblock(int fd)
+        {
+            if (fd < 0)
+            {
+                Log::err("fd error");
+                throw std::invalid_argument("fd error in setFdNonblock: " + std::to_string(fd));
+            }
+            int flag = fcntl(fd, F_GETFL);
+            flag |= O_NONBLOCK;
+            return fcntl(fd, F_SETFL, flag);
+        }
+
+    private:
+        int id;
+        int listenFd;
+        uint32_t listenEvent;
+        uint32_t connEvent;
+        int timeoutMS; /* 毫秒MS */
+        bool inlineMode; /* 运行到完成模式 */
+        int64_t loopTime = NowMs(); /* 本轮循环的时间，毫秒 */
+        int64_t timerDeadline = INT64_MAX; /* timerfd 当前的到期时间 */
+        bool timerDirty = false;
+        std::atomic<bool> isClose;
+
+        std::unique_ptr<Epoller> epoller = nullptr;
+        std::unique_ptr<Timer> timer = nullptr;
+        ThreadPool &threadpool;
+        ConnTable &users;
+    };
+
+} // namespace bre
+
+#endif // REACTOR_HPP
@@ -0,0 +1,425 @@
+#ifndef URING_REACTOR_HPP
+#define URING_REACTOR_HPP
+
+#include "uringer.hpp"
+#include "ConnTable.hpp"
+#include "../mylog/Log.hpp"
+#include "../timer/Timer.hpp"
+#include "../pool/ThreadPool.hpp"
+#include "../pool/Strand.hpp"
+#include "../http/HttpConn.hpp"
+
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>        // POLLIN, POLLOUT
+#include <sys/eventfd.h> // eventfd
+#include <sys/socket.h> // shutdown
+#include <netinet/in.h> // sockaddr_in
+#include <arpa/inet.h>  // inet_ntoa
+
+namespace bre
+{
+
+    // 基于 io_uring 的子反应堆，与 Reactor 一一对应，可在启动时通过 IOENGINE:uring 选择
+    // accept / recv / sendmsg 以 SQE 形式批量提交，完成后直接处理，不再经过就绪通知
+    // io_uring 没有 sendfile：文件段先提交 poll 等待可写，就绪后在本线程内以非阻塞方式 sendfile
+    // 每个连接同一时刻只有一个操作在途（recv、sendmsg、poll，或在线程池中处理请求）
+    // HTTP 处理与 Reactor 一样经由 strand 交给线程池，运行到完成模式下只有可能阻塞的请求才交出去
+    // 工作线程处理完后把连接放入 done 并写 eventfd，本线程在下一轮完成事件中提交它的 sendmsg 或 recv
+    class UringReactor
+    {
+    public:
+        UringReactor(int id, int listenFd, int timeoutMS, bool inlineMode, std::unique_ptr<Timer> timer,
+                     ThreadPool &threadpool, ConnTable &users)
+            : id(id), listenFd(listenFd), timeoutMS(timeoutMS), inlineMode(inlineMode), isClose(false),
+              uring(new Uringer()), timer(std::move(timer)), threadpool(threadpool), users(users)
+        {
+            wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (wakeFd < 0)
+            {
+                throw std::runtime_error("create eventfd error");
+            }
+        }
+
+        ~UringReactor()
+        {
+            close(listenFd);
+            close(wakeFd);
+        }
+
+        UringReactor(const UringReactor &) = delete;
+        UringReactor &operator=(const UringReactor &) = delete;
+
+        void Loop()
+        {
+            Log::info("UringReactor[{}] start, listenFd: {}", id, listenFd);
+            prepAccept();
+            prepWake();
+            while (!isClose)
+            {
+                if (timeoutMS > 0 && !timeoutArmed)
+                {
+                    armTimeout(timer->GetNextTick());
+                }
+                // 一次 io_uring_enter：提交上一轮产生的所有 SQE 并等待完成
+                uring->SubmitAndWait(1);
+                loopTime = NowMs();
+                uring->ForEachCqe([this](uint64_t userData, int res)
+                                  { dispatch(userData, res); });
+            }
+        }
+
+        void Stop()
+        {
+            isClose = true;
+            wake(); // 唤醒阻塞中的 SubmitAndWait
+        }
+
+    private:
+        // user_data 低 3 位为操作类型，其余位为 HttpConn 指针
+        enum : uint64_t
+        {
+            OP_ACCEPT = 1,
+            OP_TIMEOUT = 2,
+            OP_RECV = 3,
+            OP_WRITE = 4,
+            OP_POLLIN = 5,  // 可读后再 recv
+            OP_POLLOUT = 6, // 可写后 sendfile 或再 sendmsg
+            OP_WAKE = 7,    // eventfd 可读：工作线程处理完请求或 Stop
+            OP_MASK = 7
+        };
+
+        void dispatch(uint64_t userData, int res)
+        {
+            uint64_t op = userData & OP_MASK;
+            HttpConn *client = reinterpret_cast<HttpConn *>(userData & ~uint64_t(OP_MASK));
+            switch (op)
+            {
+            case OP_ACCEPT:
+                dealAccept(res);
+                break;
+            case OP_TIMEOUT:
+                timeoutArmed = false;
+                break;
+            case OP_RECV:
+                onRecv(client, res);
+                break;
+            case OP_WRITE:
+                onWrite(client, res);
+                break;
+            case OP_POLLIN:
+                onPollIn(client, res);
+                break;
+            case OP_POLLOUT:
+                onPollOut(client, res);
+                break;
+            case OP_WAKE:
+                onWake();
+                break;
+            default:
+                Log::err("Unexpected completion");
+                break;
+            }
+        }
+
+        void armTimeout(MS tick)
+        {
+            if (tick == MS::max())
+            {
+                return;
+            }
+            timeoutSpec.tv_sec = tick.count() / 1000;
+            timeoutSpec.tv_nsec = (tick.count() % 1000) * 1000000;
+            uring->PrepTimeout(&timeoutSpec, OP_TIMEOUT);
+            timeoutArmed = true;
+        }
+
+        void prepAccept()
+        {
+            acceptLen = sizeof(acceptAddr);
+            // 非阻塞：sendfile 不能阻塞反应堆线程
+            uring->PrepAccept(listenFd, (sockaddr *)&acceptAddr, &acceptLen, OP_ACCEPT, SOCK_NONBLOCK);
+        }
+
+        void prepRecv(HttpConn *client)
+        {
+            Buffer &buff = client->ReadBuffer();
+            buff.EnsureWriteable(RECV_SIZE);
+            uring->PrepRecv(client->GetFd(), buff.BeginWrite(), buff.WritableBytes(),
+                            reinterpret_cast<uint64_t>(client) | OP_RECV);
+        }
+
+        // 头部等内存段用 sendmsg（后面有文件时带 MSG_MORE），文件段等待可写后 sendfile
+        void prepWrite(HttpConn *client)
+        {
+            if (client->FileNext())
+            {
+                prepPoll(client, POLLOUT, OP_POLLOUT);
+                return;
+            }
+            uring->PrepSendmsg(client->GetFd(), client->Msg(), client->MsgFlags(),
+                               reinterpret_cast<uint64_t>(client) | OP_WRITE);
+        }
+
+        void prepPoll(HttpConn *client, unsigned events, uint64_t op)
+        {
+            uring->PrepPollAdd(client->GetFd(), events, reinterpret_cast<uint64_t>(client) | op);
+        }
+
+        void prepWake()
+        {
+            uring->PrepPollAdd(wakeFd, POLLIN, OP_WAKE);
+        }
+
+        // 任意线程调用
+        void wake()
+        {
+            uint64_t one = 1;
+            [[maybe_unused]] ssize_t ret = write(wakeFd, &one, sizeof(one));
+        }
+
+        void dealAccept(int fd)
+        {
+            prepAccept();
+            if (fd < 0)
+            { // 连接失败
+                return;
+            }
+            if (HttpConn::UserCount >= users.MaxFd() || fd >= users.MaxFd())
+            {
+                close(fd);
+                Log::warn("Clients is full");
+                return;
+            }
+            HttpConn *client = &users.Get(fd);
+            client->Init(fd, acceptAddr);
+            client->Touch(loopTime);
+            if (timeoutMS > 0)
+            {
+                timer->Add(fd, timeoutMS,
+                           std::bind(&UringReactor::dealIdle, this, client));
+            }
+            prepRecv(client);
+            Log::info("Client[{}]({}:{}) in, fd: {}, reactor: {}",
+                      HttpConn::UserCount.load(), inet_ntoa(acceptAddr.sin_addr),
+                      ntohs(acceptAddr.sin_port), fd, id);
+        }
+
+        void onRecv(HttpConn *client, int res)
+        {
+            if (res == -EAGAIN)
+            {
+                prepPoll(client, POLLIN, OP_POLLIN);
+                return;
+            }
+            if (res == -EINTR)
+            {
+                prepRecv(client);
+                return;
+            }
+            if (res <= 0)
+            {
+                closeConn(client);
+                return;
+            }
+            client->ReadBuffer().HasWritten(res);
+            extentTime(client);
+            onProcess(client);
+        }
+
+        void onWrite(HttpConn *client, int res)
+        {
+            if (res == -EAGAIN)
+            {
+                prepPoll(client, POLLOUT, OP_POLLOUT);
+                return;
+            }
+            if (res == -EINTR)
+            {
+                prepWrite(client);
+                return;
+            }
+            if (res < 0)
+            {
+                Log::err("send data error");
+                closeConn(client);
+                return;
+            }
+            client->Written(res);
+            if (client->ToWriteBytes() > 0)
+            {
+                prepWrite(client);
+            }
+            else if (client->IsKeepAlive())
+            {
+                extentTime(client);
+                onProcess(client);
+            }
+            else
+            {
+                closeConn(client);
+            }
+        }
+
+        void onPollIn(HttpConn *client, int res)
+        {
+            if (res < 0 && res != -EINTR)
+            {
+                closeConn(client);
+                return;
+            }
+            prepRecv(client);
+        }
+
+        // 可写（或对端关闭，此时 sendfile 返回 EPIPE，SIGPIPE 已由 WebServer 忽略）：发送文件段，结果与 sendmsg 完成一样处理
+        void onPollOut(HttpConn *client, int res)
+        {
+            if (res < 0 && res != -EINTR)
+            {
+                closeConn(client);
+                return;
+            }
+            if (res < 0 || !client->FileNext())
+            {
+                prepWrite(client);
+                return;
+            }
+            ssize_t len = client->SendFile();
+            onWrite(client, len >= 0 ? static_cast<int>(len) : -errno);
+        }
+
+        // 登录注册会查询 MySQL，不能阻塞整个 ring：交给线程池
+        // 运行到完成模式下就地处理，Process 在可能阻塞的请求前停下，之前的响应发送完后再经过这里交出去
+        void onProcess(HttpConn *client)
+        {
+            if (inlineMode && !client->MayBlock())
+            {
+                bool hasResponse = client->Process(false);
+                if (hasResponse || !client->MayBlock())
+                {
+                    onProcessed(client, hasResponse);
+                    return;
+                }
+            }
+            client->GetStrand().Post(threadpool, [this, client]
+                                     { finish(client, client->Process()); });
+        }
+
+        void onProcessed(HttpConn *client, bool hasResponse)
+        {
+            if (hasResponse)
+            {
+                prepWrite(client);
+            }
+            else
+            {
+                prepRecv(client);
+            }
+        }
+
+        // 工作线程中调用：交回本线程提交后续操作，done 由空变为非空时才需要唤醒
+        void finish(HttpConn *client, bool hasResponse)
+        {
+            bool first;
+            {
+                std::lock_guard<std::mutex> lock(doneMtx);
+                first = done.empty();
+                done.emplace_back(client, hasResponse);
+            }
+            if (first)
+            {
+                wake();
+            }
+        }
+
+        void onWake()
+        {
+            uint64_t cnt;
+            [[maybe_unused]] ssize_t ret = read(wakeFd, &cnt, sizeof(cnt));
+            {
+                std::lock_guard<std::mutex> lock(doneMtx);
+                doneLocal.swap(done);
+            }
+            for (auto [client, hasResponse] : doneLocal)
+            {
+                onProcessed(client, hasResponse);
+            }
+            doneLocal.clear();
+            prepWake();
+        }
+
+        // 只记录活动时间，不调整定时器；到期时再由 dealIdle 检查
+        void extentTime(HttpConn *client)
+        {
+            client->Touch(loopTime);
+        }
+
+        // 定时器到期：期间有过活动则按剩余时间重新定时，否则关闭
+        void dealIdle(HttpConn *client)
+        {
+            if (client->IsClose())
+            {
+                return;
+            }
+            int64_t idle = loopTime - client->LastActive();
+            if (idle < timeoutMS)
+            {
+                timer->Add(client->GetFd(), static_cast<int>(timeoutMS - idle),
+                           std::bind(&UringReactor::dealIdle, this, client));
+                return;
+            }
+            shutdownConn(client);
+        }
+
+        // 只在完成事件中调用，此时该连接没有在途操作
+        // 同时取消定时任务：fd 关闭后可能被其他反应堆复用，残留的任务会作用到新连接上
+        void closeConn(HttpConn *client)
+        {
+            timer->Cancel(client->GetFd());
+            client->Close();
+        }
+
+        // 超时：关闭读写，让在途的操作带着错误完成，再由完成事件关闭连接
+        void shutdownConn(HttpConn *client)
+        {
+            if (!client->IsClose())
+            {
+                shutdown(client->GetFd(), SHUT_RDWR);
+            }
+        }
+
+    private:
+        static const size_t RECV_SIZE = 4096;
+
+        int id;
+        int listenFd;
+        int timeoutMS; /* 毫秒MS */
+        bool inlineMode; /* 运行到完成模式 */
+        int64_t loopTime = NowMs(); /* 本轮循环的时间，毫秒 */
+        std::atomic<bool> isClose;
+
+        int wakeFd = -1;
+        std::mutex doneMtx;
+        std::vector<std::pair<HttpConn *, bool>> done;      // 工作线程处理完的连接及 Process 的结果
+        std::vector<std::pair<HttpConn *, bool>> doneLocal; // onWake 中与 done 交换，避免持锁提交
+
+        sockaddr_in acceptAddr{};
+        socklen_t acceptLen = sizeof(acceptAddr);
+        __kernel_timespec timeoutSpec{};
+        bool timeoutArmed = false;
+
+        std::unique_ptr<Uringer> uring = nullptr;
+        std::unique_ptr<Timer> timer = nullptr;
+        ThreadPool &threadpool;
+        ConnTable &users;
+    };
+
+} // namespace bre
+
+#endif // URING_REACTOR_HPP
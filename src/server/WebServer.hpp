@@ -1,21 +1,27 @@
 #ifndef WEBSERVER_HPP
 #define WEBSERVER_HPP
 
-#include "epoller.hpp"
+#include "Reactor.hpp"
+#include "UringReactor.hpp"
 #include "../mylog/Log.hpp"
 #include "../config/Config.hpp"
-#include "../timer/HeapTimer.hpp"
 #include "../pool/ThreadPool.hpp"
 #include "../http/HttpConn.hpp"
+#include "../timer/HeapTimer.hpp"
+#include "../timer/TimingWheel.hpp"
 
 #include <unordered_map>
 #include <string>
 #include <cstring>
 #include <memory>
+#include <vector>
+#include <thread>
+#include <algorithm>
 #include <functional>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include <csignal>
 
 #include <sys/socket.h> // socket, bind, listen, accept
 #include <netinet/in.h> // sockaddr_in
@@ -35,14 +41,29 @@ namespace bre
     {
     public:
         WebServer(LogLevel logLevel = LogLevel::DEBUG)
-            : isClose(false), epoller(new Epoller()),
-              timer(new HeapTimer()), threadpool(new ThreadPool())
+            : isClose(false), users(new ConnTable(MAX_FD)), threadpool(new ThreadPool())
         {
+            // 对端已关闭时 sendfile 没有 MSG_NOSIGNAL 可用，忽略 SIGPIPE，写失败时返回 EPIPE 由反应堆关闭连接
+            signal(SIGPIPE, SIG_IGN);
             // 初始化
             auto &conf = Config::getInstance();
             port = stoi(conf.Get("PORT").value_or("5678"));
             openLinger = conf.Get("false").value_or("false") == "false" ? false : true;
             timeoutMS = stoi(conf.Get("TIMEOUT").value_or("5000"));
+            // 子反应堆数量，0 表示按 CPU 核数
+            reactorNum = stoi(conf.Get("REACTORS").value_or("1"));
+            if (reactorNum <= 0)
+            {
+                reactorNum = std::max(1u, std::thread::hardware_concurrency());
+            }
+            // I/O 引擎：epoll（默认）或 uring
+            ioEngine = conf.Get("IOENGINE").value_or("epoll");
+            // 运行到完成：静态请求在反应堆线程内处理，不经过线程池
+            inlineMode = conf.Get("INLINE").value_or("false") == "true";
+            // 空闲超时定时器：wheel（分层时间轮，默认）或 heap（小根堆）
+            timerType = conf.Get("TIMER").value_or("wheel");
+            // 请求消息体上限（字节），超过时返回 413
+            HttpRequest::MaxBody = std::stoull(conf.Get("MAXBODY").value_or("1048576"));
             // 获取资源路径
             srcDir = std::filesystem::current_path().string() + conf.Get("PATH").value_or("/resources");
             std::cout << "srcDir////////////////////////////////" << std::endl;
@@ -62,14 +83,26 @@ namespace bre
             // 设置事件模式
             initEventMode(stoi(conf.Get("TRIGMODE").value_or("3")));
 
-            // 初始化socket
-            if (!initSocket())
+            // 初始化socket, 每个子反应堆一个监听套接字
+            for (int i = 0; i < reactorNum; ++i)
             {
-                isClose = true;
-            }
-            if (isClose)
-            {
-                throw std::runtime_error("init socket error");
+                int listenFd = initSocket(reactorNum > 1);
+                if (listenFd < 0)
+                {
+                    isClose = true;
+                    throw std::runtime_error("init socket error");
+                }
+                if (ioEngine == "uring")
+                {
+                    uringReactors.emplace_back(new UringReactor(i, listenFd, timeoutMS, inlineMode, makeTimer(),
+                                                                *threadpool, *users));
+                }
+                else
+                {
+                    reactors.emplace_back(new Reactor(i, listenFd, listenEvent, connEvent,
+                                                      timeoutMS, inlineMode, makeTimer(),
+                                                      *threadpool, *users));
+                }
             }
 
             // 初始化日志
@@ -80,6 +113,8 @@ namespace bre
                 Log::info("port: {}, openLinger: {}, timeoutMS: {}, \nsrcDir: {}",
                           port, openLinger, timeoutMS, srcDir);
                 Log::info("TRIGMode: {}", conf.Get("TRIGMODE").value_or("3"));
+                Log::info("Reactors: {}, IOEngine: {}, Inline: {}, Timer: {}, MaxBody: {}",
+                          reactorNum, ioEngine, inlineMode, timerType, HttpRequest::MaxBody);
 
                 Log::info("srcDir: {}", srcDir);
                 Log::info("log level: {}", (int)logLevel);
@@ -92,63 +127,61 @@ namespace bre
 
         ~WebServer()
         {
-            close(listenFd);
-            isClose = true;
+            Stop();
             Log::info("WebServer closed");
         }
 
         void Start()
         {
-            int timeMs = -1;
-            if (!isClose)
+            if (isClose)
             {
-                Log::info("WebServer start");
+                return;
             }
-            while (!isClose)
+            Log::info("WebServer start, reactors: {}, ioEngine: {}", reactorNum, ioEngine);
+            if (ioEngine == "uring")
             {
-                if (timeoutMS > 0)
-                {
-                    timeMs = timer->GetNextTick().count();
-                }
-                int eventCnt = epoller->Wait(timeMs);
-                for (int i = 0; i < eventCnt; ++i)
-                {
-                    int fd = epoller->GetEventFd(i);
-                    uint32_t events = epoller->GetEvents(i);
-                    if (fd == listenFd)
-                    {
-                        dealListen();
-                    }
-                    else if (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))
-                    {
-                        assert(users.count(fd) > 0);
-                        closeConn(&users[fd]);
-                    }
-                    else if (events & EPOLLIN)
-                    {
-                        assert(users.count(fd) > 0);
-                        dealRead(&users[fd]);
-                    }
-                    else if (events & EPOLLOUT)
-                    {
-                        assert(users.count(fd) > 0);
-                        dealWrite(&users[fd]);
-                    }
-                    else
-                    {
-                        Log::err("Unexpected event");
-                    }
-                }
+                runLoops(uringReactors);
+            }
+            else
+            {
+                runLoops(reactors);
             }
         }
 
         void Stop()
         {
             isClose = true;
+            for (auto &reactor : reactors)
+            {
+                reactor->Stop();
+            }
+            for (auto &reactor : uringReactors)
+            {
+                reactor->Stop();
+            }
         }
 
     private:
-        bool initSocket()
+        // 子反应堆 1..N-1 各自运行在独立线程，0 号运行在调用线程
+        template <typename T>
+        void runLoops(std::vector<std::unique_ptr<T>> &loops)
+        {
+            std::vector<std::thread> threads;
+            threads.reserve(loops.size() - 1);
+            for (size_t i = 1; i < loops.size(); ++i)
+            {
+                threads.emplace_back([&loops, i]
+                                     { loops[i]->Loop(); });
+            }
+            loops[0]->Loop();
+            for (auto &thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        // 创建监听套接字，多反应堆时开启 SO_REUSEPORT，每个反应堆一个
+        int initSocket(bool reusePort)
         {
             sockaddr_in addr;
             if (port < 1024 || port > 65535)
@@ -165,19 +198,19 @@ namespace bre
                 optLinger.l_linger = 3; // 超时时间
             }
 
-            listenFd = socket(AF_INET, SOCK_STREAM, 0);
+            int listenFd = socket(AF_INET, SOCK_STREAM, 0);
 
             if (listenFd < 0)
             {
                 Log::err("Create socket error");
-                return false;
+                return -1;
             }
             int ret = setsockopt(listenFd, SOL_SOCKET, SO_LINGER, &optLinger, sizeof(optLinger));
             if (ret < 0)
             {
                 close(listenFd);
                 Log::err("Init linger error");
-                return false;
+                return -1;
             }
             int opt = 1;
 
@@ -186,7 +219,18 @@ namespace bre
             {
                 close(listenFd);
                 Log::err("Set reuseAddr error");
-                return false;
+                return -1;
+            }
+
+            if (reusePort)
+            {
+                ret = setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+                if (ret < 0)
+                {
+                    close(listenFd);
+                    Log::err("Set reusePort error");
+                    return -1;
+                }
             }
 
             ret = bind(listenFd, (sockaddr *)&addr, sizeof(addr));
@@ -194,7 +238,7 @@ namespace bre
             {
                 close(listenFd);
                 Log::err("Bind port: {} error: {}", port, strerror(errno));
-                return false;
+                return -1;
             }
 
             ret = listen(listenFd, 6);
@@ -202,21 +246,13 @@ namespace bre
             {
                 close(listenFd);
                 Log::err("Listen port: {} error", port);
-                return false;
-            }
-
-            ret = epoller->AddFd(listenFd, EPOLLIN | listenEvent);
-            if (ret == 0)
-            {
-                close(listenFd);
-                Log::err("Add listen error");
-                return false;
+                return -1;
             }
 
             setFdNonblock(listenFd);
             Log::info("Server port: {}", port);
 
-            return true;
+            return listenFd;
         }
 
         void initEventMode(int trigMode)
@@ -245,169 +281,14 @@ namespace bre
             HttpConn::IsET = (connEvent & EPOLLET);
         }
 
-        void addClient(int fd, sockaddr_in addr)
-        {
-            if (fd < 0)
-            {
-                Log::err("fd error");
-                return;
-            }
-            users[fd].Init(fd, addr);
-            if (timeoutMS > 0)
-            {
-                timer->Add(fd, timeoutMS,
-                           std::bind(&WebServer::closeConn, this, &users[fd]));
-            }
-            epoller->AddFd(fd, connEvent | EPOLLIN);
-            setFdNonblock(fd);
-            Log::info("Client[{}]({}:{}) in, fd: {}",
-                      HttpConn::UserCount, inet_ntoa(addr.sin_addr),
-                      ntohs(addr.sin_port), fd);
-        }
-
-        void dealListen()
-        {
-            sockaddr_in addr;
-            socklen_t len = sizeof(addr);
-            do
-            {
-                int fd = accept(listenFd, (sockaddr *)&addr, &len);
-                if (fd <= 0)
-                { // 连接失败
-                    return;
-                }
-                else if (HttpConn::UserCount >= MAX_FD)
-                {
-                    sendError(fd, "Server busy");
-                    Log::warn("Clients is full");
-                    return;
-                }
-                addClient(fd, addr);
-            } while (listenEvent & EPOLLET);
-        }
-
-        void dealWrite(HttpConn *client)
-        {
-            if (client == nullptr)
-            {
-                Log::err("client is nullptr");
-                throw std::invalid_argument("client is nullptr");
-            }
-            extentTime(client);
-            threadpool->enqueue(std::bind(&WebServer::onWrite, this, client));
-        }
-
-        void dealRead(HttpConn *client)
-        {
-            if (client == nullptr)
-            {
-                Log::err("client is nullptr");
-                throw std::invalid_argument("client is nullptr");
-            }
-            extentTime(client);
-            threadpool->enqueue(std::bind(&WebServer::onRead, this, client));
-        }
-
-        void sendError(int fd, const char *info)
-        {
-            int ret = send(fd, info, strlen(info), 0);
-            if (ret < 0)
-            {
-                Log::err("send error to client error");
-            }
-            close(fd);
-        }
-
-        void extentTime(HttpConn *client)
-        {
-            if (client == nullptr)
-            {
-                Log::err("client is nullptr");
-                throw std::invalid_argument("client is nullptr");
-            }
-            if (timeoutMS > 0)
-            {
-                timer->Adjust(client->GetFd(), (MS)timeoutMS);
-            }
-        }
-
-        void closeConn(HttpConn *client)
-        {
-            if (client == nullptr)
-            {
-                Log::err("client is nullptr");
-                throw std::invalid_argument("client is nullptr");
-            }
-            // Log::info("Client close fd: {}", client->GetFd());
-            epoller->DelFd(client->GetFd());
-            client->Close();
-        }
-
-        void onRead(HttpConn *client)
+        // 每个子反应堆一个定时器，按配置选择实现
+        std::unique_ptr<Timer> makeTimer() const
         {
-            if (client == nullptr)
+            if (timerType == "heap")
             {
-                Log::err("client is nullptr");
-                throw std::invalid_argument("client is nullptr");
-            }
-            int ret = -1;
-            int readErrno = 0;
-            ret = client->Read(&readErrno);
-            if (ret <= 0 && readErrno != EAGAIN)
-            {
-                closeConn(client);
-                return;
-            }
-            onProcess(client);
-        }
-
-        void onWrite(HttpConn *client)
-        {
-            if (client == nullptr)
-            {
-                Log::err("client is nullptr");
-                throw std::invalid_argument("client is nullptr");
-            }
-            int ret = -1;
-            int writeErrno = 0;
-            ret = client->Write(&writeErrno);
-            if (client->ToWriteBytes() == 0)
-            {
-                if (client->IsKeepAlive())
-                {
-                    onProcess(client);
-                    return;
-                }
-            }
-            else if (ret < 0)
-            {
-                if (writeErrno == EAGAIN)
-                {
-                    epoller->ModFd(client->GetFd(), connEvent | EPOLLOUT);
-                    return;
-                }
-                else
-                {
-                    Log::err("send data error");
-                }
-            }
-        }
-
-        void onProcess(HttpConn *client)
-        {
-            if (client == nullptr)
-            {
-                Log::err("client is nullptr");
-                throw std::invalid_argument("client is nullptr");
-            }
-            if (client->Process())
-            {
-                epoller->ModFd(client->GetFd(), connEvent | EPOLLOUT);
-            }
-            else
-            {
-                epoller->ModFd(client->GetFd(), connEvent | EPOLLIN);
+                return std::make_unique<HeapTimer>();
             }
+            return std::make_unique<TimingWheel>();
         }
 
         static int setFdNonblock(int fd)
@@ -427,18 +308,21 @@ namespace bre
         int port = 5678;
         bool openLinger = false;
         int timeoutMS = 10000; /* 毫秒MS */
+        int reactorNum = 1;
+        std::string ioEngine;
+        bool inlineMode = false;
+        std::string timerType;
         bool isClose;
-        int listenFd;
         std::string srcDir;
 
         uint32_t listenEvent;
         uint32_t connEvent;
 
-        std::unique_ptr<Epoller> epoller = nullptr;
-        std::unique_ptr<HeapTimer> timer = nullptr;
+        // 析构顺序：先停线程池（等待任务结束），再销毁反应堆和连接表
+        std::unique_ptr<ConnTable> users = nullptr;
+        std::vector<std::unique_ptr<Reactor>> reactors;
+        std::vector<std::unique_ptr<UringReactor>> uringReactors;
         std::unique_ptr<ThreadPool> threadpool = nullptr;
-
-        std::unordered_map<int, HttpConn> users;
     };
 
 } // namespace bre
@@ -0,0 +1,139 @@
+// 长连接压测客户端，用于对比 epoll 与 io_uring 两种 I/O 引擎
+// 用法：
+//   1. config.txt 中设置 IOENGINE:epoll 启动服务器，运行 ./benchServer
+//   2. 改为 IOENGINE:uring 重启服务器，再次运行 ./benchServer
+// ./benchServer [host] [port] [连接数] [秒数] [线程数] [路径]
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+using namespace std::chrono;
+
+std::atomic<long long> totalRequests{0};
+std::atomic<long long> totalBytes{0};
+std::atomic<long long> totalErrors{0};
+std::atomic<bool> running{true};
+
+int connectTo(const char *host, int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, host, &addr.sin_addr);
+    if (connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int opt = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    return fd;
+}
+
+// 读取一个完整响应（按 Content-length 分帧），返回响应字节数，出错返回 -1
+long long readResponse(int fd, std::string &pending) {
+    char buf[65536];
+    size_t headerEnd;
+    while ((headerEnd = pending.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            return -1;
+        }
+        pending.append(buf, n);
+    }
+    size_t bodyLen = 0;
+    size_t pos = pending.find("Content-length: ");
+    if (pos != std::string::npos && pos < headerEnd) {
+        bodyLen = std::strtoull(pending.c_str() + pos + 16, nullptr, 10);
+    }
+    size_t total = headerEnd + 4 + bodyLen;
+    while (pending.size() < total) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            return -1;
+        }
+        pending.append(buf, n);
+    }
+    pending.erase(0, total);
+    return static_cast<long long>(total);
+}
+
+void worker(const char *host, int port, int conns, const std::string &path) {
+    std::string request = "GET " + path + " HTTP/1.1\r\n"
+                          "Host: " + std::string(host) + "\r\n"
+                          "Connection: keep-alive\r\n\r\n";
+    std::vector<int> fds;
+    std::vector<std::string> pending(conns);
+    for (int i = 0; i < conns; ++i) {
+        fds.push_back(connectTo(host, port));
+    }
+    while (running) {
+        for (int i = 0; i < conns && running; ++i) {
+            if (fds[i] < 0) {
+                fds[i] = connectTo(host, port);
+                pending[i].clear();
+                if (fds[i] < 0) {
+                    totalErrors++;
+                    continue;
+                }
+            }
+            long long n = -1;
+            if (write(fds[i], request.data(), request.size()) == (ssize_t)request.size()) {
+                n = readResponse(fds[i], pending[i]);
+            }
+            if (n < 0) {
+                totalErrors++;
+                close(fds[i]);
+                fds[i] = -1;
+                continue;
+            }
+            totalRequests++;
+            totalBytes += n;
+        }
+    }
+    for (int fd : fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const char *host = argc > 1 ? argv[1] : "127.0.0.1";
+    int port = argc > 2 ? std::atoi(argv[2]) : 5678;
+    int conns = argc > 3 ? std::atoi(argv[3]) : 64;
+    int seconds = argc > 4 ? std::atoi(argv[4]) : 10;
+    int threads = argc > 5 ? std::atoi(argv[5]) : 4;
+    std::string path = argc > 6 ? argv[6] : "/index.html";
+
+    std::cout << "bench " << host << ":" << port << path << ", conns: " << conns
+              << ", threads: " << threads << ", seconds: " << seconds << std::endl;
+
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; ++i) {
+        int share = conns / threads + (i < conns % threads ? 1 : 0);
+        pool.emplace_back(worker, host, port, share, std::cref(path));
+    }
+    auto start = steady_clock::now();
+    std::this_thread::sleep_for(seconds * 1s);
+    running = false;
+    for (auto &t : pool) {
+        t.join();
+    }
+    double elapsed = duration<double>(steady_clock::now() - start).count();
+
+    std::cout << "requests: " << totalRequests << ", errors: " << totalErrors << "\n"
+              << "requests/sec: " << totalRequests / elapsed << "\n"
+              << "MB/sec: " << totalBytes / elapsed / (1024 * 1024) << std::endl;
+    return 0;
+}
@@ -2,8 +2,10 @@
 #define EPOLLER_HPP
 #include <vector>
 #include <stdexcept>
+#include <cstdint>
 #include <unistd.h>     // close
 #include <sys/epoll.h>  // epoll_create, epoll_ctl, epoll_wait
+#include <sys/timerfd.h> // timerfd_create, timerfd_settime
 
 
 namespace bre {
@@ -19,6 +21,9 @@ public:
     }
 
     ~Epoller() {
+        if (timerFd >= 0) {
+            close(timerFd);
+        }
         close(epollFd);
     }
 
@@ -42,6 +47,27 @@ public:
         return 0 == epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
     }
 
+    // data.ptr 版本：事件直接携带对象指针，分发时无需再按 fd 查表
+    bool AddFd(int fd, uint32_t events, void* ptr) {
+        if (fd < 0) {
+            return false;
+        }
+        struct epoll_event ev{};
+        ev.data.ptr = ptr;
+        ev.events = events;
+        return 0 == epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    bool ModFd(int fd, uint32_t events, void* ptr) {
+        if (fd < 0) {
+            return false;
+        }
+        struct epoll_event ev{};
+        ev.data.ptr = ptr;
+        ev.events = events;
+        return 0 == epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+    }
+
     bool DelFd(int fd) {
         if (fd < 0) {
             return false;
@@ -50,6 +76,34 @@ public:
         return 0 == epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, &ev);
     }
 
+    // 创建 timerfd 并注册，到期时作为普通可读事件返回，事件携带 ptr
+    bool AddTimerFd(void* ptr) {
+        timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (timerFd < 0) {
+            return false;
+        }
+        return AddFd(timerFd, EPOLLIN, ptr);
+    }
+
+    // timeoutMs 毫秒后到期；0 表示立即到期，负数表示取消。可以在其他线程调用
+    bool ArmTimerFd(int64_t timeoutMs) {
+        struct itimerspec spec{};
+        if (timeoutMs == 0) {
+            spec.it_value.tv_nsec = 1;
+        } else if (timeoutMs > 0) {
+            spec.it_value.tv_sec = timeoutMs / 1000;
+            spec.it_value.tv_nsec = (timeoutMs % 1000) * 1000000;
+        }
+        return 0 == timerfd_settime(timerFd, 0, &spec, nullptr);
+    }
+
+    // 读走到期次数，清除可读状态
+    void ReadTimerFd() {
+        uint64_t expirations;
+        while (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+        }
+    }
+
     int Wait(int timeoutMs = -1) {
         return epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), timeoutMs);
     }
@@ -61,6 +115,13 @@ public:
         return events[i].data.fd;
     }
 
+    void* GetEventPtr(int i) const {
+        if (i < 0 || i >= (int)events.size()) {
+            throw std::out_of_range("index out of range");
+        }
+        return events[i].data.ptr;
+    }
+
     uint32_t GetEvents(int i) const {
         if (i < 0 || i >= (int)events.size()) {
             throw std::out_of_range("index out of range");
@@ -70,6 +131,7 @@ public:
         
 private:
     int epollFd;
+    int timerFd = -1;
 
     std::vector<struct epoll_event> events;    
 };
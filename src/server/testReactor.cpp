@@ -0,0 +1,134 @@
+// 子反应堆测试：客户端在大文件发送中途断开，两种 I/O 引擎都应关闭该连接并继续服务
+// g++ -std=c++20 testReactor.cpp -o testReactor -pthread -lmysqlcppconn
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "Reactor.hpp"
+#include "UringReactor.hpp"
+#include "../timer/TimingWheel.hpp"
+
+using namespace bre;
+using std::cout;
+using std::string;
+
+const size_t BIG_SIZE = 16 * 1024 * 1024;
+
+// 127.0.0.1 上的非阻塞监听套接字，端口由内核分配
+int listenLocal(int *port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    assert(bind(fd, (sockaddr *)&addr, sizeof(addr)) == 0 && listen(fd, 16) == 0);
+    socklen_t len = sizeof(addr);
+    getsockname(fd, (sockaddr *)&addr, &len);
+    *port = ntohs(addr.sin_port);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+int connectLocal(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int rcvbuf = 4096; // 接收缓冲区小，服务端在文件发送中途就会被阻塞
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    assert(connect(fd, (sockaddr *)&addr, sizeof(addr)) == 0);
+    return fd;
+}
+
+void sendAll(int fd, const string &s) {
+    assert(send(fd, s.data(), s.size(), 0) == static_cast<ssize_t>(s.size()));
+}
+
+template <typename Pred>
+bool waitFor(Pred pred) {
+    for (int i = 0; i < 500; ++i) {
+        if (pred()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+// 读出一部分响应后断开：先发 FIN 使服务端进入 CLOSE_WAIT，再带着未读数据关闭使内核回复 RST
+// 此后服务端的 sendfile 以 EPIPE 失败（浏览器中途放弃下载时也是如此）
+void abortDownload(int port) {
+    int fd = connectLocal(port);
+    sendAll(fd, "GET /big.jpg HTTP/1.1\r\nConnection: keep-alive\r\n\r\n");
+    char buf[4096];
+    assert(recv(fd, buf, sizeof(buf), 0) > 0);
+    shutdown(fd, SHUT_WR);
+    close(fd);
+}
+
+// 断开后仍能完整下载
+void fullDownload(int port) {
+    int fd = connectLocal(port);
+    sendAll(fd, "GET /big.jpg HTTP/1.1\r\nConnection: close\r\n\r\n");
+    string out;
+    char buf[65536];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        out.append(buf, n);
+    }
+    close(fd);
+    assert(out.compare(0, 15, "HTTP/1.1 200 OK") == 0);
+    assert(out.size() - (out.find("\r\n\r\n") + 4) == BIG_SIZE);
+}
+
+template <typename Engine, typename Make>
+void testAbort(const char *name, Make make) {
+    ThreadPool threadpool(2);
+    ConnTable users(1024);
+    int port = 0;
+    std::unique_ptr<Engine> reactor = make(listenLocal(&port), threadpool, users);
+    std::thread loop([&] { reactor->Loop(); });
+
+    for (int i = 0; i < 4; ++i) {
+        abortDownload(port);
+    }
+    assert(waitFor([] { return HttpConn::UserCount == 0; }));
+    fullDownload(port);
+    assert(waitFor([] { return HttpConn::UserCount == 0; }));
+
+    reactor->Stop();
+    loop.join();
+    cout << name << " abort OK\n";
+}
+
+int main() {
+    Log::Instance().SetLevel(LogLevel::OFF);
+    // 与 WebServer 相同：对端已关闭时 sendfile 返回 EPIPE，而不是以 SIGPIPE 终止进程
+    signal(SIGPIPE, SIG_IGN);
+    char tmpl[] = "/tmp/reactorXXXXXX";
+    string dir = mkdtemp(tmpl);
+    std::ofstream(dir + "/big.jpg", std::ios::binary) << string(BIG_SIZE, 'x');
+    HttpConn::SrcDir = dir.c_str();
+    HttpConn::IsET = true;
+
+    testAbort<Reactor>("epoll", [](int listenFd, ThreadPool &threadpool, ConnTable &users) {
+        return std::make_unique<Reactor>(0, listenFd, EPOLLRDHUP | EPOLLET, EPOLLONESHOT | EPOLLRDHUP | EPOLLET,
+                                         10000, false, std::make_unique<TimingWheel>(), threadpool, users);
+    });
+    testAbort<UringReactor>("uring", [](int listenFd, ThreadPool &threadpool, ConnTable &users) {
+        return std::make_unique<UringReactor>(0, listenFd, 10000, false, std::make_unique<TimingWheel>(),
+                                              threadpool, users);
+    });
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
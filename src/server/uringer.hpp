@@ -0,0 +1,211 @@
+#ifndef URINGER_HPP
+#define URINGER_HPP
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>         // close, syscall
+#include <sys/mman.h>       // mmap, munmap
+#include <sys/syscall.h>    // __NR_io_uring_setup, __NR_io_uring_enter
+#include <sys/socket.h>     // sockaddr, msghdr
+#include <sys/uio.h>        // iovec
+#include <linux/io_uring.h>
+
+
+namespace bre {
+
+// io_uring 的薄封装，直接使用系统调用，不依赖 liburing
+// 只在拥有它的线程上使用：提交和收割都不加锁
+class Uringer {
+public:
+    explicit Uringer(unsigned entries = 4096) {
+        io_uring_params params{};
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd < 0) {
+            throw std::runtime_error(std::string("io_uring_setup error: ") + strerror(errno));
+        }
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+            close(ringFd);
+            throw std::runtime_error("io_uring: kernel too old (no IORING_FEAT_SINGLE_MMAP)");
+        }
+
+        /* SQ 和 CQ 共享一次映射 */
+        ringSize = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                            params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        ringPtr = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (ringPtr == MAP_FAILED) {
+            close(ringFd);
+            throw std::runtime_error("io_uring: mmap ring error");
+        }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            munmap(ringPtr, ringSize);
+            close(ringFd);
+            throw std::runtime_error("io_uring: mmap sqes error");
+        }
+
+        char* base = static_cast<char*>(ringPtr);
+        sqHead = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+        sqEntries = params.sq_entries;
+        sqArray = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+
+        localTail = *sqTail;
+        /* sqArray 固定为恒等映射 */
+        for (unsigned i = 0; i < sqEntries; ++i) {
+            sqArray[i] = i;
+        }
+    }
+
+    ~Uringer() {
+        munmap(sqes, sqesSize);
+        munmap(ringPtr, ringSize);
+        close(ringFd);
+    }
+
+    Uringer(const Uringer&) = delete;
+    Uringer& operator=(const Uringer&) = delete;
+
+    // flags 同 accept4，如 SOCK_NONBLOCK
+    void PrepAccept(int fd, sockaddr* addr, socklen_t* len, uint64_t userData, int flags = 0) {
+        io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(addr);
+        sqe->addr2 = reinterpret_cast<uint64_t>(len);
+        sqe->accept_flags = static_cast<unsigned>(flags);
+        sqe->user_data = userData;
+    }
+
+    void PrepRecv(int fd, void* buf, size_t len, uint64_t userData) {
+        io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(buf);
+        sqe->len = static_cast<unsigned>(len);
+        sqe->user_data = userData;
+    }
+
+    void PrepWritev(int fd, const iovec* iov, int iovCnt, uint64_t userData) {
+        io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_WRITEV;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(iov);
+        sqe->len = static_cast<unsigned>(iovCnt);
+        sqe->user_data = userData;
+    }
+
+    // msg 及其指向的 iovec 必须在完成前保持有效，flags 如 MSG_MORE
+    void PrepSendmsg(int fd, const msghdr* msg, int flags, uint64_t userData) {
+        io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(msg);
+        sqe->len = 1;
+        sqe->msg_flags = static_cast<unsigned>(flags);
+        sqe->user_data = userData;
+    }
+
+    // 单次 poll，完成时 res 为就绪的事件
+    void PrepPollAdd(int fd, unsigned events, uint64_t userData) {
+        io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = fd;
+        sqe->poll32_events = events;
+        sqe->user_data = userData;
+    }
+
+    // ts 必须在完成前保持有效
+    void PrepTimeout(__kernel_timespec* ts, uint64_t userData) {
+        io_uring_sqe* sqe = getSqe();
+        sqe->opcode = IORING_OP_TIMEOUT;
+        sqe->fd = -1;
+        sqe->addr = reinterpret_cast<uint64_t>(ts);
+        sqe->len = 1;
+        sqe->user_data = userData;
+    }
+
+    // 一次系统调用提交所有排队的 SQE，并至少等待 waitNr 个完成事件
+    int SubmitAndWait(unsigned waitNr = 1) {
+        unsigned toSubmit = flushSq();
+        unsigned flags = waitNr > 0 ? IORING_ENTER_GETEVENTS : 0;
+        int ret = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, waitNr, flags, nullptr, 0));
+        if (ret < 0 && errno != EINTR && errno != EBUSY && errno != ETIME) {
+            throw std::runtime_error(std::string("io_uring_enter error: ") + strerror(errno));
+        }
+        return ret;
+    }
+
+    // 依次处理已完成的事件，返回处理数量
+    template<typename Func>
+    int ForEachCqe(Func&& func) {
+        unsigned head = *cqHead;
+        unsigned tail = std::atomic_ref<unsigned>(*cqTail).load(std::memory_order_acquire);
+        int count = 0;
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes[head & cqMask];
+            func(cqe.user_data, cqe.res);
+            ++head;
+            ++count;
+        }
+        std::atomic_ref<unsigned>(*cqHead).store(head, std::memory_order_release);
+        return count;
+    }
+
+private:
+    io_uring_sqe* getSqe() {
+        unsigned head = std::atomic_ref<unsigned>(*sqHead).load(std::memory_order_acquire);
+        if (localTail - head >= sqEntries) {
+            /* SQ 已满，先提交 */
+            SubmitAndWait(0);
+            head = std::atomic_ref<unsigned>(*sqHead).load(std::memory_order_acquire);
+            if (localTail - head >= sqEntries) {
+                throw std::runtime_error("io_uring: submission queue full");
+            }
+        }
+        io_uring_sqe* sqe = &sqes[localTail & sqMask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        ++localTail;
+        return sqe;
+    }
+
+    // 发布尾指针，返回内核尚未消费的 SQE 数量
+    unsigned flushSq() {
+        std::atomic_ref<unsigned>(*sqTail).store(localTail, std::memory_order_release);
+        return localTail - std::atomic_ref<unsigned>(*sqHead).load(std::memory_order_acquire);
+    }
+
+private:
+    int ringFd;
+    void* ringPtr;
+    size_t ringSize;
+    io_uring_sqe* sqes;
+    size_t sqesSize;
+
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqArray;
+    unsigned sqMask;
+    unsigned sqEntries;
+    unsigned localTail;     // 尚未发布给内核的尾指针
+
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned cqMask;
+    io_uring_cqe* cqes;
+};
+
+
+} // namespace bre
+
+#endif //URINGER_HPP
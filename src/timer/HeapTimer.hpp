@@ -1,6 +1,8 @@
 #ifndef HEAP_TIMER_HPP
 #define HEAP_TIMER_HPP
 
+#include "Timer.hpp"
+
 #include <queue>
 #include <unordered_map>
 #include <chrono>
@@ -10,11 +12,6 @@
 
 namespace bre {
 
-using Clock = std::chrono::high_resolution_clock;
-using MS = std::chrono::milliseconds;
-using TimeStamp = Clock::time_point;
-using TimeoutCallback = std::function<void()>;
-
 struct TimerNode {
     int id;
     TimeStamp expires;
@@ -25,15 +22,15 @@ struct TimerNode {
     }
 };
 
-class HeapTimer {
+class HeapTimer : public Timer {
 public:
     explicit HeapTimer(size_t initialCapacity = 64) {
         heap.reserve(initialCapacity);
     }
-    ~HeapTimer() { Clear(); }
+    ~HeapTimer() override { Clear(); }
 
     // 添加定时任务
-    void Add(int id, int ms, const TimeoutCallback& callback) {
+    void Add(int id, int ms, const TimeoutCallback& callback) override {
         if (id < 0) {
             return;
         }
@@ -51,7 +48,7 @@ public:
     }
 
     // 调整定时任务的过期时间
-    void Adjust(int id, MS newTimeout) {
+    void Adjust(int id, MS newTimeout) override {
         auto it = nodeIndices.find(id);
         if (it == nodeIndices.end()) {
             return;
@@ -63,8 +60,16 @@ public:
         }
     }
 
+    // 取消定时任务
+    void Cancel(int id) override {
+        auto it = nodeIndices.find(id);
+        if (it != nodeIndices.end()) {
+            del(it->second);
+        }
+    }
+
     // 清空所有定时任务
-    void Clear() {
+    void Clear() override {
         heap.clear();
         nodeIndices.clear();
     }
@@ -73,7 +78,7 @@ public:
     // 获取下一个到期任务的时间间隔
 	// 如果没有任务，返回一个最大时间间隔
 	// 如果有任务，返回到期时间与当前时间的时间间隔
-    [[nodiscard]] MS GetNextTick() {
+    [[nodiscard]] MS GetNextTick() override {
         tick();
 
         if (heap.empty()) {
@@ -169,10 +174,10 @@ private:
             return;
         }
 
-        auto index = it->second;
-        heap[index].cb();
-
-        del(index);
+        // 先删除再回调：回调中可能重新添加同一个 id
+        TimeoutCallback cb = std::move(heap[it->second].cb);
+        del(it->second);
+        cb();
     }
 
 private:
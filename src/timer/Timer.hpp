@@ -0,0 +1,39 @@
+#ifndef TIMER_HPP
+#define TIMER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace bre {
+
+using Clock = std::chrono::high_resolution_clock;
+using MS = std::chrono::milliseconds;
+using TimeStamp = Clock::time_point;
+using TimeoutCallback = std::function<void()>;
+
+// 反应堆每轮循环缓存一次的粗粒度时钟，毫秒
+inline int64_t NowMs() {
+    return std::chrono::duration_cast<MS>(Clock::now().time_since_epoch()).count();
+}
+
+// 定时器接口，反应堆通过它使用 HeapTimer 或 TimingWheel（配置项 TIMER:heap|wheel）
+// 所有方法只能在所属反应堆线程中调用；id 为连接的 fd
+class Timer {
+public:
+    virtual ~Timer() = default;
+
+    // 添加定时任务，id 已存在时只调整过期时间
+    virtual void Add(int id, int ms, const TimeoutCallback& callback) = 0;
+    // 调整定时任务的过期时间
+    virtual void Adjust(int id, MS newTimeout) = 0;
+    // 取消定时任务
+    virtual void Cancel(int id) = 0;
+    // 清空所有定时任务
+    virtual void Clear() = 0;
+    // 处理到期任务，返回距下一个到期任务的时间间隔，没有任务时返回 MS::max()
+    [[nodiscard]] virtual MS GetNextTick() = 0;
+};
+
+}   // namespace bre
+#endif // TIMER_HPP
@@ -0,0 +1,261 @@
+#ifndef TIMING_WHEEL_HPP
+#define TIMING_WHEEL_HPP
+
+#include "Timer.hpp"
+
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace bre {
+
+// 分层时间轮：4 层，每层 64 个槽，精度 1ms，可覆盖约 4.6 小时（更长的定时先放在最高层，到期前再重新放置）
+// 定时任务按 id 存放在数组中，槽内为双向链表，添加、调整、取消都是 O(1)
+// 每层用一个 64 位位图记录非空槽，推进时间和计算下一次到期时间时可以跳过空槽
+class TimingWheel : public Timer {
+public:
+    explicit TimingWheel(size_t initialCapacity = 64) : base(Clock::now()) {
+        entries.reserve(initialCapacity);
+        for (auto &level : slots) {
+            for (auto &head : level) {
+                head = NIL;
+            }
+        }
+    }
+    ~TimingWheel() override { Clear(); }
+
+    // 添加定时任务
+    void Add(int id, int ms, const TimeoutCallback& callback) override {
+        if (id < 0) {
+            return;
+        }
+        if (static_cast<size_t>(id) >= entries.size()) {
+            entries.resize(id + 1);
+        }
+        Entry &e = entries[id];
+        if (e.active) {
+            // 已经存在的任务，调整定时时间
+            Adjust(id, MS(ms));
+            return;
+        }
+        e.cb = callback;
+        e.expires = nowTick() + ms;
+        link(id);
+        ++count;
+    }
+
+    // 调整定时任务的过期时间
+    void Adjust(int id, MS newTimeout) override {
+        if (!isActive(id)) {
+            return;
+        }
+        unlink(id);
+        entries[id].expires = nowTick() + newTimeout.count();
+        link(id);
+    }
+
+    // 取消定时任务
+    void Cancel(int id) override {
+        if (!isActive(id)) {
+            return;
+        }
+        unlink(id);
+        entries[id].active = false;
+        entries[id].cb = nullptr;
+        --count;
+    }
+
+    // 清空所有定时任务
+    void Clear() override {
+        entries.clear();
+        for (auto &level : slots) {
+            for (auto &head : level) {
+                head = NIL;
+            }
+        }
+        for (auto &bits : occupied) {
+            bits = 0;
+        }
+        count = 0;
+    }
+
+    // 获取下一个到期任务的时间间隔
+    // 先处理已到期的任务；高层槽只在需要下放时才唤醒一次
+    [[nodiscard]] MS GetNextTick() override {
+        int64_t now = nowTick();
+        advance(now);
+
+        if (count == 0) {
+            return MS::max();
+        }
+        int64_t d = nextEvent() - now;
+        // 不足 1ms 时返回 1ms，避免外层空转
+        return MS(d < 1 ? 1 : d);
+    }
+
+    size_t Size() const {
+        return count;
+    }
+
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int64_t SLOT_MASK = SLOTS - 1;
+    static const int NIL = -1;
+
+    struct Entry {
+        int64_t expires = 0;    // 以 base 为起点的毫秒数
+        TimeoutCallback cb;
+        int prev = NIL;
+        int next = NIL;
+        int8_t level = 0;
+        uint8_t slot = 0;
+        bool active = false;
+    };
+
+    int64_t nowTick() const {
+        return std::chrono::duration_cast<MS>(Clock::now() - base).count();
+    }
+
+    bool isActive(int id) const {
+        return id >= 0 && static_cast<size_t>(id) < entries.size() && entries[id].active;
+    }
+
+    // 按到期时间与当前时间的最高不同位选择层：第 l 层的槽对应的时间窗口一定还没开始
+    void link(int id) {
+        Entry &e = entries[id];
+        int64_t expires = e.expires > current ? e.expires : current + 1;
+        if ((expires >> (SLOT_BITS * LEVELS)) != (current >> (SLOT_BITS * LEVELS))) {
+            // 超出时间轮范围：先放在当前轮次的最后一个时间点，到时再按真实到期时间放置
+            expires = current | ((int64_t(1) << (SLOT_BITS * LEVELS)) - 1);
+            if (expires <= current) {
+                expires = current + 1;
+            }
+        }
+        int level = 0;
+        while (level < LEVELS - 1 &&
+               (expires >> (SLOT_BITS * (level + 1))) != (current >> (SLOT_BITS * (level + 1)))) {
+            ++level;
+        }
+        int slot = static_cast<int>((expires >> (SLOT_BITS * level)) & SLOT_MASK);
+
+        e.level = static_cast<int8_t>(level);
+        e.slot = static_cast<uint8_t>(slot);
+        e.active = true;
+        e.prev = NIL;
+        e.next = slots[level][slot];
+        if (e.next != NIL) {
+            entries[e.next].prev = id;
+        }
+        slots[level][slot] = id;
+        occupied[level] |= uint64_t(1) << slot;
+    }
+
+    void unlink(int id) {
+        Entry &e = entries[id];
+        if (e.prev != NIL) {
+            entries[e.prev].next = e.next;
+        } else {
+            slots[e.level][e.slot] = e.next;
+            if (e.next == NIL) {
+                occupied[e.level] &= ~(uint64_t(1) << e.slot);
+            }
+        }
+        if (e.next != NIL) {
+            entries[e.next].prev = e.prev;
+        }
+        e.prev = e.next = NIL;
+    }
+
+    // 把时间推进到 now：依次处理第 0 层的非空槽和各层的下放点
+    void advance(int64_t now) {
+        while (current < now) {
+            int64_t boundary = (current | SLOT_MASK) + 1;
+            // 当前轮次中下一个非空槽（位图中只会有大于当前位置的槽）
+            uint64_t rest = occupied[0] & ~((uint64_t(2) << (current & SLOT_MASK)) - 1);
+            if (rest != 0) {
+                int64_t tick = (current & ~SLOT_MASK) + std::countr_zero(rest);
+                if (tick <= now) {
+                    current = tick;
+                    expire(static_cast<int>(tick & SLOT_MASK));
+                    continue;
+                }
+            }
+            if (boundary > now) {
+                current = now;
+                break;
+            }
+            current = boundary;
+            cascade();
+            expire(0);
+        }
+    }
+
+    // 第 0 层转完一圈：把上层对应槽中的任务按到期时间重新放置，从高层到低层
+    void cascade() {
+        for (int level = LEVELS - 1; level >= 1; --level) {
+            int64_t mask = (int64_t(1) << (SLOT_BITS * level)) - 1;
+            if ((current & mask) != 0) {
+                continue;
+            }
+            int slot = static_cast<int>((current >> (SLOT_BITS * level)) & SLOT_MASK);
+            int id = slots[level][slot];
+            slots[level][slot] = NIL;
+            occupied[level] &= ~(uint64_t(1) << slot);
+            while (id != NIL) {
+                int next = entries[id].next;
+                link(id);
+                id = next;
+            }
+        }
+    }
+
+    // 执行第 0 层某个槽中的任务；先摘除再回调，回调中可以安全地添加、调整或取消任务
+    void expire(int slot) {
+        while (slots[0][slot] != NIL) {
+            int id = slots[0][slot];
+            unlink(id);
+            Entry &e = entries[id];
+            if (e.expires > current) {
+                // 超出范围被提前放置的任务，还没到期
+                link(id);
+                continue;
+            }
+            e.active = false;
+            --count;
+            TimeoutCallback cb = std::move(e.cb);
+            e.cb = nullptr;
+            cb();
+        }
+    }
+
+    // 最近一次需要处理的时间点：第 0 层为到期时间，上层为下放时间
+    int64_t nextEvent() const {
+        int64_t best = INT64_MAX;
+        for (int level = 0; level < LEVELS; ++level) {
+            if (occupied[level] == 0) {
+                continue;
+            }
+            int shift = SLOT_BITS * (level + 1);
+            int64_t tick = ((current >> shift) << shift) +
+                           (int64_t(std::countr_zero(occupied[level])) << (SLOT_BITS * level));
+            if (tick < best) {
+                best = tick;
+            }
+        }
+        return best;
+    }
+
+    TimeStamp base;
+    int64_t current = 0;                    // 已处理到的时间点
+    size_t count = 0;
+    std::vector<Entry> entries;             // 按 id 索引
+    int slots[LEVELS][SLOTS];               // 每个槽的链表头
+    uint64_t occupied[LEVELS] = {};         // 非空槽位图
+};
+
+}   // namespace bre
+#endif // TIMING_WHEEL_HPP
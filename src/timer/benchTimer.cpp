@@ -0,0 +1,95 @@
+// 定时器性能测试：HeapTimer vs TimingWheel，10 万个定时任务（对应 10 万个空闲连接）
+// 添加：每个连接一次 Add；调整：模拟每次读写事件的 extentTime；到期：全部任务在 1 秒内陆续到期
+// g++ -std=c++20 -O2 benchTimer.cpp -o benchTimer
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <vector>
+#include "HeapTimer.hpp"
+#include "TimingWheel.hpp"
+
+using namespace bre;
+
+const int TIMERS = 100000;
+const int ADJUSTS = 1000000;
+const int TIMEOUT_MS = 60000;
+
+struct Result {
+    double add;     // 每次操作的纳秒数
+    double adjust;
+    double cancel;
+    double expire;
+};
+
+double nsPerOp(Clock::time_point start, int ops) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+template<typename T>
+Result bench() {
+    Result r{};
+    std::mt19937 rng(1);
+    int fired = 0;
+    auto cb = [&fired] { ++fired; };
+    {
+        T timer;
+        auto start = Clock::now();
+        for (int i = 0; i < TIMERS; ++i) {
+            timer.Add(i, TIMEOUT_MS, cb);
+        }
+        r.add = nsPerOp(start, TIMERS);
+
+        std::vector<int> ids(ADJUSTS);
+        for (auto &id : ids) {
+            id = rng() % TIMERS;
+        }
+        start = Clock::now();
+        for (int id : ids) {
+            timer.Adjust(id, MS(TIMEOUT_MS));
+        }
+        r.adjust = nsPerOp(start, ADJUSTS);
+
+        start = Clock::now();
+        for (int i = 0; i < TIMERS; ++i) {
+            timer.Cancel(i);
+        }
+        r.cancel = nsPerOp(start, TIMERS);
+    }
+    {
+        // 到期处理只统计 GetNextTick 本身的耗时，不含等待
+        T timer;
+        for (int i = 0; i < TIMERS; ++i) {
+            timer.Add(i, rng() % 1000, cb);
+        }
+        std::chrono::duration<double, std::nano> busy{0};
+        fired = 0;
+        while (fired < TIMERS) {
+            auto start = Clock::now();
+            MS t = timer.GetNextTick();
+            busy += Clock::now() - start;
+            if (t == MS::max()) {
+                break;
+            }
+            std::this_thread::sleep_for(t);
+        }
+        r.expire = busy.count() / TIMERS;
+    }
+    return r;
+}
+
+void print(const char* name, const Result &r) {
+    std::cout << std::setw(8) << name << std::setw(12) << r.add << std::setw(12) << r.adjust
+              << std::setw(12) << r.cancel << std::setw(12) << r.expire << "\n";
+}
+
+int main() {
+    std::cout << TIMERS << " timers, ns/op\n"
+              << std::setw(8) << "timer" << std::setw(12) << "add" << std::setw(12) << "adjust"
+              << std::setw(12) << "cancel" << std::setw(12) << "expire" << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    print("heap", bench<HeapTimer>());
+    print("wheel", bench<TimingWheel>());
+    return 0;
+}
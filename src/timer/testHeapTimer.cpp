@@ -36,8 +36,29 @@ void testTaskFunction() {
     }
 }
 
+// 回调中重新添加自己（空闲超时的延后检查就是这样做的），任务不能被随后的删除误删
+void testReAddInCallback() {
+    HeapTimer timer;
+    int count = 0;
+    std::function<void()> again = [&] {
+        if (++count < 3) {
+            timer.Add(1, 50, again);
+        }
+    };
+    timer.Add(1, 50, again);
+    while (true) {
+        auto t = timer.GetNextTick();
+        if (t == MS::max()) {
+            break;
+        }
+        std::this_thread::sleep_for(t);
+    }
+    std::cout << "Re-added task ran " << count << " times (expect 3)\n";
+}
+
 int main() {
     testTaskFunction();
+    testReAddInCallback();
     return 0;
 
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <vector>
+#include <cassert>
+#include "TimingWheel.hpp"
+
+using namespace bre;
+
+// 随机添加、调整、取消定时任务，检查每个任务都在到期后不久执行且只执行一次
+void testRandomTimers() {
+    const int n = 2000;
+    TimingWheel wheel;
+    std::mt19937 rng(42);
+    std::vector<Clock::time_point> deadline(n);
+    std::vector<int> fired(n, 0);
+    std::vector<bool> cancelled(n, false);
+    std::vector<Clock::time_point> firedAt(n);
+
+    auto start = Clock::now();
+    for (int i = 0; i < n; ++i) {
+        int ms = rng() % 300;
+        deadline[i] = Clock::now() + MS(ms);
+        wheel.Add(i, ms, [&, i] { ++fired[i]; firedAt[i] = Clock::now(); });
+    }
+    for (int i = 0; i < n; i += 7) {
+        int ms = 100 + rng() % 5000;
+        deadline[i] = Clock::now() + MS(ms);
+        wheel.Adjust(i, MS(ms));
+    }
+    for (int i = 3; i < n; i += 11) {
+        wheel.Cancel(i);
+        cancelled[i] = true;
+    }
+
+    while (true) {
+        MS t = wheel.GetNextTick();
+        if (t == MS::max()) {
+            break;
+        }
+        std::this_thread::sleep_for(t);
+    }
+
+    int late = 0;
+    for (int i = 0; i < n; ++i) {
+        if (cancelled[i]) {
+            assert(fired[i] == 0);
+            continue;
+        }
+        assert(fired[i] == 1);
+        assert(firedAt[i] >= deadline[i] - MS(1));
+        if (firedAt[i] - deadline[i] > MS(20)) {
+            ++late;
+        }
+    }
+    auto total = std::chrono::duration_cast<MS>(Clock::now() - start).count();
+    std::cout << "Random timers OK, late(>20ms): " << late << ", total " << total << "ms\n";
+}
+
+// 回调中重新添加自己，以及超过时间轮范围的定时任务
+void testReAddAndOverflow() {
+    TimingWheel wheel;
+    int count = 0;
+    std::function<void()> again = [&] {
+        if (++count < 5) {
+            wheel.Add(1, 10, again);
+        }
+    };
+    wheel.Add(1, 10, again);
+    wheel.Add(2, 24 * 3600 * 1000, [] { assert(false); });
+    MS next = wheel.GetNextTick();
+    while (count < 5) {
+        std::this_thread::sleep_for(next);
+        next = wheel.GetNextTick();
+    }
+    assert(wheel.Size() == 1);
+    assert(next > MS(3600 * 1000));
+    std::cout << "Re-add in callback OK, next tick " << next.count() << "ms\n";
+}
+
+int main() {
+    testRandomTimers();
+    testReAddAndOverflow();
+    return 0;
+}